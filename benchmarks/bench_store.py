@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""Benchmark results store and regression gate.
+
+record   Merge a host benchmark report (benchmarks/host/run.py --json) and
+         a footprint report (benchmarks/footprint.sh <board> <json-out>)
+         into benchmarks/results/<commit>.json.
+compare  Diff a result against a baseline: cycles per op (median) for
+         every benchmark key and text/data/bss for every footprint app.
+         Exits 1 when anything grew beyond its tolerance.
+
+Usage:
+    python3 benchmarks/bench_store.py record --bench out.json --footprint fp.json
+    python3 benchmarks/bench_store.py compare benchmarks/results/baseline.json \\
+        benchmarks/results/<commit>.json --cycles-tolerance 10
+"""
+
+from __future__ import annotations
+
+import argparse
+import datetime
+import json
+import platform
+import subprocess
+import sys
+from pathlib import Path
+
+BENCH_DIR = Path(__file__).resolve().parent
+REPO_ROOT = BENCH_DIR.parent
+RESULTS_DIR = BENCH_DIR / "results"
+
+SECTIONS = ("text", "data", "bss")
+
+
+def _git_commit() -> str:
+    result = subprocess.run(["git", "rev-parse", "--short=12", "HEAD"],
+                            capture_output=True, text=True, cwd=REPO_ROOT)
+    return result.stdout.strip() if result.returncode == 0 else "unknown"
+
+
+def _load(path: Path) -> dict:
+    try:
+        return json.loads(path.read_text())
+    except (OSError, json.JSONDecodeError) as e:
+        raise SystemExit(f"error: cannot read {path}: {e}")
+
+
+def record(bench: Path | None, footprint: Path | None,
+           out: Path | None, commit: str | None) -> Path:
+    """Write one result file combining the given reports."""
+    if bench is None and footprint is None:
+        raise SystemExit("error: record needs --bench and/or --footprint")
+
+    commit = commit or _git_commit()
+    result: dict = {
+        "commit": commit,
+        "date": datetime.datetime.now(datetime.timezone.utc)
+        .isoformat(timespec="seconds"),
+        "host": f"{platform.system()}-{platform.machine()}",
+    }
+    if bench is not None:
+        result["bench"] = _load(bench)
+    if footprint is not None:
+        result["footprint"] = _load(footprint)
+
+    out = out or RESULTS_DIR / f"{commit}.json"
+    out.parent.mkdir(parents=True, exist_ok=True)
+    out.write_text(json.dumps(result, indent=2) + "\n")
+    print(f"Recorded {out}")
+    return out
+
+
+def _cycles_by_key(result: dict) -> dict[str, float]:
+    """Map "<suite>/<key>" to median cycles per op."""
+    cycles = {}
+    for suite, report in result.get("bench", {}).items():
+        for r in report.get("results", []):
+            cycles[f"{suite}/{r['key']}"] = r["median_cycles"]
+    return cycles
+
+
+def _sizes_by_app(result: dict) -> dict[str, dict]:
+    fp = result.get("footprint", {})
+    return {a["name"]: a for a in fp.get("apps", [])}
+
+
+def _pct(base: float, cur: float) -> float:
+    if base == 0:
+        return 0.0 if cur == 0 else float("inf")
+    return (cur - base) * 100.0 / base
+
+
+def compare(baseline: dict, current: dict, cycles_tol: float,
+            cycles_floor: float, size_tol: float) -> list[str]:
+    """Print the diff and return one message per regression.
+
+    A benchmark regresses when its median grew by more than cycles_tol
+    percent and by more than cycles_floor cycles (so a 2 -> 3 cycle
+    change in a nop loop is not reported).  A footprint section regresses
+    when it grew by more than size_tol percent.  A benchmark key or
+    footprint app present in the baseline but missing from the current
+    result (e.g. an app that failed to build) is a regression too.
+    Cycle counts are only compared between results recorded on the same
+    host.
+    """
+    regressions = []
+
+    base_cycles = _cycles_by_key(baseline)
+    cur_cycles = _cycles_by_key(current)
+    if (base_cycles and cur_cycles
+            and baseline.get("host") != current.get("host")):
+        print(f"warning: not comparing cycle counts across hosts "
+              f"({baseline.get('host')} vs {current.get('host')})",
+              file=sys.stderr)
+        base_cycles = cur_cycles = {}
+    if base_cycles and cur_cycles:
+        print(f"{'benchmark':<40} {'base':>9} {'current':>9} {'delta':>8}")
+        for key, base in base_cycles.items():
+            cur = cur_cycles.get(key)
+            if cur is None:
+                print(f"{key:<40} {base:9.2f} {'-':>9} {'missing':>8}")
+                regressions.append(f"{key}: missing from current result")
+                continue
+            pct = _pct(base, cur)
+            flag = ""
+            if pct > cycles_tol and cur - base > cycles_floor:
+                flag = "  REGRESSION"
+                regressions.append(f"{key}: {base:.2f} -> {cur:.2f} cycles "
+                                   f"({pct:+.1f}%)")
+            print(f"{key:<40} {base:9.2f} {cur:9.2f} {pct:+7.1f}%{flag}")
+        for key in cur_cycles.keys() - base_cycles.keys():
+            print(f"{key:<40} {'-':>9} {cur_cycles[key]:9.2f} {'new':>8}")
+
+    base_sizes = _sizes_by_app(baseline)
+    cur_sizes = _sizes_by_app(current)
+    if base_sizes and cur_sizes:
+        base_board = baseline["footprint"].get("board")
+        cur_board = current["footprint"].get("board")
+        if base_board != cur_board:
+            print(f"warning: footprint boards differ ({base_board} vs "
+                  f"{cur_board})", file=sys.stderr)
+        print(f"\n{'footprint':<24} {'section':<6} {'base':>9} "
+              f"{'current':>9} {'delta':>8}")
+        for name, base in base_sizes.items():
+            cur = cur_sizes.get(name)
+            if cur is None:
+                print(f"{name:<24} {'-':<6} {'':>9} {'-':>9} {'missing':>8}")
+                regressions.append(f"{name}: missing from current result")
+                continue
+            for sec in SECTIONS:
+                pct = _pct(base[sec], cur[sec])
+                flag = ""
+                if cur[sec] > base[sec] and pct > size_tol:
+                    flag = "  REGRESSION"
+                    regressions.append(f"{name} {sec}: {base[sec]} -> "
+                                       f"{cur[sec]} bytes ({pct:+.1f}%)")
+                print(f"{name:<24} {sec:<6} {base[sec]:9d} {cur[sec]:9d} "
+                      f"{pct:+7.1f}%{flag}")
+
+    if not (base_cycles and cur_cycles) and not (base_sizes and cur_sizes):
+        raise SystemExit("error: baseline and current share no comparable "
+                         "benchmark or footprint data")
+    return regressions
+
+
+def main(argv: list[str] | None = None) -> int:
+    p = argparse.ArgumentParser(description="Benchmark results store "
+                                            "and regression gate")
+    sub = p.add_subparsers(dest="cmd", required=True)
+
+    rec = sub.add_parser("record", help="Store a result for this commit")
+    rec.add_argument("--bench", type=Path, default=None, metavar="FILE",
+                     help="benchmarks/host/run.py --json report")
+    rec.add_argument("--footprint", type=Path, default=None, metavar="FILE",
+                     help="benchmarks/footprint.sh JSON report")
+    rec.add_argument("--commit", default=None,
+                     help="Commit id to record under (default: git HEAD)")
+    rec.add_argument("-o", "--output", type=Path, default=None,
+                     help="Output file (default: benchmarks/results/"
+                          "<commit>.json)")
+
+    cmp_ = sub.add_parser("compare", help="Fail on regression vs a baseline")
+    cmp_.add_argument("baseline", type=Path)
+    cmp_.add_argument("current", type=Path)
+    cmp_.add_argument("--cycles-tolerance", type=float, default=10.0,
+                      metavar="PCT",
+                      help="Allowed cycles/op growth in percent (default: 10)")
+    cmp_.add_argument("--cycles-floor", type=float, default=1.0,
+                      metavar="CYCLES",
+                      help="Ignore growth below this many cycles/op "
+                           "(default: 1)")
+    cmp_.add_argument("--size-tolerance", type=float, default=0.0,
+                      metavar="PCT",
+                      help="Allowed text/data/bss growth in percent "
+                           "(default: 0)")
+    args = p.parse_args(argv)
+
+    if args.cmd == "record":
+        record(args.bench, args.footprint, args.output, args.commit)
+        return 0
+
+    regressions = compare(_load(args.baseline), _load(args.current),
+                          args.cycles_tolerance, args.cycles_floor,
+                          args.size_tolerance)
+    if regressions:
+        print(f"\n{len(regressions)} regression(s):", file=sys.stderr)
+        for msg in regressions:
+            print(f"  {msg}", file=sys.stderr)
+        return 1
+    print("\nNo regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -2,12 +2,14 @@
 # Firmware footprint analysis: OZ vs C++ vs C (OZ-070)
 # Builds each benchmark app and extracts ELF section sizes.
 #
-# Usage: ./benchmarks/footprint.sh [board]
+# Usage: ./benchmarks/footprint.sh [board] [json-out]
 # Default board: nrf52833dk/nrf52833
+# With json-out, also writes the sizes as JSON for benchmarks/bench_store.py.
 
 set -euo pipefail
 
 BOARD="${1:-nrf52833dk/nrf52833}"
+JSON_OUT="${2:-}"
 SIZE_TOOL="$HOME/.local/zephyr-sdk-1.0.0/gnu/arm-zephyr-eabi/bin/arm-zephyr-eabi-size"
 
 if [ ! -x "$SIZE_TOOL" ]; then
@@ -30,24 +32,38 @@ echo "  Board: $BOARD"
 echo "============================================"
 echo ""
 
+JSON_APPS=""
+FAILED=0
+
 for idx in "${!NAMES[@]}"; do
         name="${NAMES[$idx]}"
         app="${APPS[$idx]}"
         echo "--- $name ($app) ---"
 
-        west build -p -b "$BOARD" "$app" >/dev/null 2>&1
+        # A failed app is left out of the JSON (bench_store.py compare
+        # reports it as missing) and fails the script at the end
         ELF="build/zephyr/zephyr.elf"
-
-        if [ ! -f "$ELF" ]; then
-                echo "  ERROR: $ELF not found"
+        if ! west build -p -b "$BOARD" "$app" >/dev/null 2>&1 || [ ! -f "$ELF" ]; then
+                echo "  ERROR: build failed"
+                echo ""
+                FAILED=$((FAILED + 1))
                 continue
         fi
 
-        "$SIZE_TOOL" "$ELF" | tail -1 | \
-                awk '{printf "  text=%d  data=%d  bss=%d  total=%d\n", $1, $2, $3, $4}'
+        read -r text data bss total _ < <("$SIZE_TOOL" "$ELF" | tail -1)
+        printf "  text=%d  data=%d  bss=%d  total=%d\n" "$text" "$data" "$bss" "$total"
         echo ""
+
+        JSON_APPS+="${JSON_APPS:+,}
+    {\"name\": \"$name\", \"app\": \"$app\", \"text\": $text, \"data\": $data, \"bss\": $bss, \"total\": $total}"
 done
 
+if [ -n "$JSON_OUT" ]; then
+        printf '{\n  "board": "%s",\n  "apps": [%s\n  ]\n}\n' "$BOARD" "$JSON_APPS" > "$JSON_OUT"
+        echo "Footprint JSON written to $JSON_OUT"
+        echo ""
+fi
+
 echo "============================================"
 echo "  ROM/RAM reports (last build: C memory)"
 echo "============================================"
@@ -57,3 +73,9 @@ west build -t rom_report 2>/dev/null || echo "  (rom_report not available)"
 echo ""
 echo "--- RAM Report ---"
 west build -t ram_report 2>/dev/null || echo "  (ram_report not available)"
+
+if [ "$FAILED" -gt 0 ]; then
+        echo ""
+        echo "ERROR: $FAILED app(s) failed to build"
+        exit 1
+fi
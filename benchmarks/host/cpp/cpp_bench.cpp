@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2025 Rodrigo Peixoto <rodrigopex@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * C++ host benchmark — the classes of benchmarks/cpp/src/bench_classes.hpp
+ * timed with oz_bench under the same keys as objz_bench_main.c, so
+ * benchmarks/host/run.py can print the two side by side.
+ */
+#include <cstdint>
+
+#include "oz_bench.h"
+#include "bench_classes.hpp"
+
+/* ── Fixture ──────────────────────────────────────────────────────── */
+
+struct Fixture {
+	BenchBase *volatile base;
+	BenchBase *volatile child;
+	BenchBase *volatile gchild;
+	SimpleString *items[10];
+	StringArray *arr;
+};
+
+static const char *const str_data[] = {
+	"s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9",
+};
+
+static Fixture *fx(void *ctx)
+{
+	return static_cast<Fixture *>(ctx);
+}
+
+/* ── C baselines ──────────────────────────────────────────────────── */
+
+static void c_nop(void *self)
+{
+	(void)self;
+	__asm__ volatile("" ::: "memory");
+}
+
+static void (*volatile c_nop_ptr)(void *) = c_nop;
+
+/* ── Section 1: Allocation ────────────────────────────────────────── */
+
+template <typename T> static void k_new_delete(void *ctx, int n)
+{
+	(void)ctx;
+	for (int i = 0; i < n; i++) {
+		BenchBase *volatile obj = new T();
+		delete obj;
+	}
+}
+
+/* ── Section 2: Dispatch ──────────────────────────────────────────── */
+
+static void k_fn_ptr(void *ctx, int n)
+{
+	for (int i = 0; i < n; i++) {
+		c_nop_ptr(ctx);
+	}
+}
+
+static void k_direct(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+
+	for (int i = 0; i < n; i++) {
+		base->BenchBase::nop();
+	}
+}
+
+static void k_static_method(void *ctx, int n)
+{
+	(void)ctx;
+	for (int i = 0; i < n; i++) {
+		BenchBase::classNop();
+	}
+}
+
+static void k_virtual0(void *ctx, int n)
+{
+	for (int i = 0; i < n; i++) {
+		fx(ctx)->base->nop();
+	}
+}
+
+static void k_virtual1(void *ctx, int n)
+{
+	for (int i = 0; i < n; i++) {
+		fx(ctx)->child->nop();
+	}
+}
+
+static void k_virtual2(void *ctx, int n)
+{
+	for (int i = 0; i < n; i++) {
+		fx(ctx)->gchild->nop();
+	}
+}
+
+static void k_lambda(void *ctx, int n)
+{
+	int (*fn)(void) = []() { return 0; };
+	int sum = 0;
+
+	(void)ctx;
+	for (int i = 0; i < n; i++) {
+		OZ_BENCH_KEEP(fn);
+		sum += fn();
+	}
+	oz_bench_sink += (uint64_t)sum;
+}
+
+/* ── Section 3: Object Lifecycle ──────────────────────────────────── */
+
+static void k_new_retain_release(void *ctx, int n)
+{
+	(void)ctx;
+	for (int i = 0; i < n; i++) {
+		BenchBase *obj = new BenchBase();
+		obj->retain();
+		obj->release();
+		obj->release();
+	}
+}
+
+/* ── Section 4: Reference Counting ────────────────────────────────── */
+
+static void k_retain_release(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+
+	for (int i = 0; i < n; i++) {
+		base->retain();
+		base->release();
+	}
+}
+
+/* ── Section 5: Properties / Synchronization ──────────────────────── */
+
+static void k_prop_get(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+	int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		int v = base->value();
+
+		OZ_BENCH_KEEP(v);
+		sum += v;
+	}
+	oz_bench_sink += (uint64_t)sum;
+}
+
+static void k_prop_set(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+
+	for (int i = 0; i < n; i++) {
+		base->setValue(i);
+		OZ_BENCH_KEEP(base);
+	}
+}
+
+static void k_atomic_get(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+	int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		sum += base->atomicValue();
+	}
+	oz_bench_sink += (uint64_t)sum;
+}
+
+static void k_atomic_set(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+
+	for (int i = 0; i < n; i++) {
+		base->setAtomicValue(i);
+	}
+}
+
+static void k_sync(void *ctx, int n)
+{
+	BenchBase *base = fx(ctx)->base;
+
+	for (int i = 0; i < n; i++) {
+		base->syncNop();
+	}
+}
+
+/* ── Section 6: Collections ───────────────────────────────────────── */
+
+static void k_raw_sum(void *ctx, int n)
+{
+	static const int32_t raw_arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	int32_t sum = 0;
+
+	(void)ctx;
+	for (int i = 0; i < n; i++) {
+		for (unsigned int j = 0; j < 10; j++) {
+			sum += *(volatile const int32_t *)&raw_arr[j];
+		}
+	}
+	oz_bench_sink += (uint64_t)sum;
+}
+
+static void k_index(void *ctx, int n)
+{
+	SimpleString *const *items = fx(ctx)->items;
+	unsigned int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		sum += items[5]->length();
+	}
+	oz_bench_sink += sum;
+}
+
+static void k_iterator(void *ctx, int n)
+{
+	StringArray &arr = *fx(ctx)->arr;
+	unsigned int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		for (SimpleString *str : arr) {
+			sum += str->length();
+		}
+	}
+	oz_bench_sink += sum;
+}
+
+static void k_loop(void *ctx, int n)
+{
+	SimpleString *const *items = fx(ctx)->items;
+	unsigned int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		for (unsigned int j = 0; j < 10; j++) {
+			sum += items[j]->length();
+		}
+	}
+	oz_bench_sink += sum;
+}
+
+/* ── Main ─────────────────────────────────────────────────────────── */
+
+int main()
+{
+	Fixture f;
+
+	f.base = new BenchBase();
+	f.child = new BenchChild();
+	f.gchild = new BenchGrandChild();
+	for (int i = 0; i < 10; i++) {
+		f.items[i] = new SimpleString(str_data[i], 2);
+	}
+	f.arr = new StringArray(f.items, 10);
+
+	oz_bench_begin("cpp");
+
+	oz_bench_section("1. Allocation");
+	oz_bench_run("alloc.base", "new + delete (BenchBase)",
+		     SLOW_ITERATIONS, k_new_delete<BenchBase>, &f);
+	oz_bench_run("alloc.child", "new + delete (BenchChild)",
+		     SLOW_ITERATIONS, k_new_delete<BenchChild>, &f);
+	oz_bench_run("alloc.grandchild", "new + delete (BenchGrandChild)",
+		     SLOW_ITERATIONS, k_new_delete<BenchGrandChild>, &f);
+
+	oz_bench_section("2. Dispatch");
+	oz_bench_run("dispatch.fn_ptr", "C function pointer (baseline)",
+		     FAST_ITERATIONS, k_fn_ptr, &f);
+	oz_bench_run("dispatch.static", "Direct call (non-virtual)",
+		     FAST_ITERATIONS, k_direct, &f);
+	oz_bench_run("dispatch.class", "Static method call",
+		     FAST_ITERATIONS, k_static_method, &f);
+	oz_bench_run("dispatch.vtable0", "Virtual dispatch (depth=0)",
+		     ITERATIONS, k_virtual0, &f);
+	oz_bench_run("dispatch.vtable1", "Virtual dispatch (depth=1)",
+		     ITERATIONS, k_virtual1, &f);
+	oz_bench_run("dispatch.vtable2", "Virtual dispatch (depth=2)",
+		     ITERATIONS, k_virtual2, &f);
+	oz_bench_run("dispatch.block", "Lambda (non-capturing, fn ptr decay)",
+		     FAST_ITERATIONS, k_lambda, &f);
+
+	oz_bench_section("3. Object Lifecycle");
+	oz_bench_run("lifecycle.alloc_release", "new + delete",
+		     SLOW_ITERATIONS, k_new_delete<BenchBase>, &f);
+	oz_bench_run("lifecycle.alloc_retain_release",
+		     "new + retain + 2x release",
+		     SLOW_ITERATIONS, k_new_retain_release, &f);
+
+	oz_bench_section("4. Reference Counting");
+	oz_bench_run("refcount.retain_release", "atomic inc + dec pair",
+		     ITERATIONS, k_retain_release, &f);
+
+	oz_bench_section("5. Properties / Synchronization");
+	oz_bench_run("props.get", "property get (nonatomic)",
+		     FAST_ITERATIONS, k_prop_get, &f);
+	oz_bench_run("props.set", "property set (nonatomic)",
+		     FAST_ITERATIONS, k_prop_set, &f);
+	oz_bench_run("props.atomic_get", "property get (atomic, k_spinlock)",
+		     ITERATIONS, k_atomic_get, &f);
+	oz_bench_run("props.atomic_set", "property set (atomic, k_spinlock)",
+		     ITERATIONS, k_atomic_set, &f);
+	oz_bench_run("sync.empty", "synchronized (k_spinlock)",
+		     ITERATIONS, k_sync, &f);
+
+	oz_bench_section("6. Collections");
+	oz_bench_run("foundation.raw_sum",
+		     "Raw int32_t[] sum (10 elems, baseline)",
+		     FAST_ITERATIONS, k_raw_sum, &f);
+	oz_bench_run("foundation.index", "SimpleString*[10] access + length()",
+		     FAST_ITERATIONS, k_index, &f);
+	oz_bench_run("foundation.forin",
+		     "StringArray iterator (virtual, length)",
+		     ITERATIONS, k_iterator, &f);
+	oz_bench_run("foundation.loop", "SimpleString*[10] loop + length()",
+		     ITERATIONS, k_loop, &f);
+
+	oz_bench_section("Object Sizes");
+	oz_bench_size("BenchBase (vptr + refcount + props + lock)",
+		      sizeof(BenchBase));
+	oz_bench_size("BenchChild", sizeof(BenchChild));
+	oz_bench_size("BenchGrandChild", sizeof(BenchGrandChild));
+	oz_bench_size("SimpleString", sizeof(SimpleString));
+	oz_bench_size("Pointer size", sizeof(void *));
+
+	int rc = oz_bench_end();
+
+	delete f.arr;
+	for (int i = 0; i < 10; i++) {
+		delete f.items[i];
+	}
+	delete f.gchild;
+	delete f.child;
+	delete f.base;
+	return rc;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2025 Rodrigo Peixoto <rodrigopex@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host stand-in for <zephyr/spinlock.h> so benchmarks/cpp/src/
+ * bench_classes.hpp builds unchanged for the host C++ baseline.
+ * A test-and-set lock, like the OZ_PLATFORM_HOST_MT spinlock.
+ */
+#ifndef ZEPHYR_SPINLOCK_HOST_SHIM_H
+#define ZEPHYR_SPINLOCK_HOST_SHIM_H
+
+#include <atomic>
+
+struct k_spinlock {
+	std::atomic<int> locked{0};
+};
+
+typedef int k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *l)
+{
+	while (l->locked.exchange(1, std::memory_order_acquire)) {
+		while (l->locked.load(std::memory_order_relaxed)) {
+		}
+	}
+	return 0;
+}
+
+static inline void k_spin_unlock(struct k_spinlock *l, k_spinlock_key_t key)
+{
+	(void)key;
+	l->locked.store(0, std::memory_order_release);
+}
+
+#endif /* ZEPHYR_SPINLOCK_HOST_SHIM_H */
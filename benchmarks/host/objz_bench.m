@@ -0,0 +1,347 @@
+/* oz-pool: OZObject=1,BenchBase=8,BenchChild=4,BenchGrandChild=4,BenchSuite=1,OZQ31=16,OZArray=4,OZDictionary=4,OZString=16 */
+/*
+ * Copyright (c) 2025 Rodrigo Peixoto <rodrigopex@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Objective-Z host benchmark — the six sections of benchmarks/objc
+ * (Allocation, Dispatch, Lifecycle, Refcount, Properties/Sync,
+ * Foundation) as BenchSuite kernels.  Each kernel performs one
+ * operation n times; objz_bench_main.c times them with oz_bench.
+ *
+ * Built with tests/tools/compile_and_run.py --bench (ARC is on, so
+ * explicit retain/release from the firmware benchmark become strong
+ * local copies that the transpiler retains and releases).
+ */
+
+#import "OZFoundationBase.h"
+
+/* ── Protocol to force vtable (PROTOCOL) dispatch ─────────────────── */
+
+@protocol Benchable
+- (void)nop;
+- (int)getValue;
+@end
+
+/* ── BenchBase (depth=0) ──────────────────────────────────────────── */
+
+@interface BenchBase : OZObject <Benchable> {
+	int _x;
+}
+@property(nonatomic, assign) int value;
+@property(assign) int atomicValue;
+- (void)nop;
+- (int)getValue;
++ (void)classNop;
+- (void)syncNop;
+- (OZArray *)createBenchStringArray;
+- (OZDictionary *)createBenchDict;
+@end
+
+@implementation BenchBase
+@synthesize value = _value;
+@synthesize atomicValue = _atomicValue;
+
+- (void)nop
+{
+}
+
+- (int)getValue
+{
+	return _x;
+}
+
++ (void)classNop
+{
+}
+
+- (void)syncNop
+{
+	@synchronized(self) {
+	}
+}
+
+- (OZArray *)createBenchStringArray
+{
+	return @[@"s0", @"s1", @"s2", @"s3", @"s4", @"s5", @"s6", @"s7", @"s8", @"s9"];
+}
+
+- (OZDictionary *)createBenchDict
+{
+	return @{@"bench_key": @42};
+}
+
+@end
+
+/* ── BenchChild (depth=1) ─────────────────────────────────────────── */
+
+@interface BenchChild : BenchBase
+@end
+
+@implementation BenchChild
+@end
+
+/* ── BenchGrandChild (depth=2) ────────────────────────────────────── */
+
+@interface BenchGrandChild : BenchChild
+@end
+
+@implementation BenchGrandChild
+@end
+
+/* ── Block baseline (OZ emits blocks as static C functions) ───────── */
+
+static int block_nop_fn(void)
+{
+	return 0;
+}
+
+/* ── BenchSuite — one kernel per measured operation ───────────────── */
+
+@interface BenchSuite : OZObject {
+	BenchBase *_base;
+	BenchChild *_child;
+	BenchGrandChild *_gchild;
+	OZArray *_arr;
+	OZDictionary *_dict;
+}
+- (void)setUp;
+- (void)tearDown;
+- (void)allocBase:(int)n;
+- (void)allocChild:(int)n;
+- (void)allocGrandChild:(int)n;
+- (void)staticDispatch:(int)n;
+- (void)classDispatch:(int)n;
+- (void)vtableDepth0:(int)n;
+- (void)vtableDepth1:(int)n;
+- (void)vtableDepth2:(int)n;
+- (int)blockInvoke:(int)n;
+- (void)allocRetainRelease:(int)n;
+- (void)retainRelease:(int)n;
+- (int)propertyGet:(int)n;
+- (void)propertySet:(int)n;
+- (int)atomicPropertyGet:(int)n;
+- (void)atomicPropertySet:(int)n;
+- (void)synchronizedEmpty:(int)n;
+- (unsigned int)arrayIndex:(int)n;
+- (unsigned int)arrayForIn:(int)n;
+- (unsigned int)arrayLoop:(int)n;
+- (unsigned int)dictLookup:(int)n;
+@end
+
+@implementation BenchSuite
+
+- (void)setUp
+{
+	_base = [[BenchBase alloc] init];
+	_child = [[BenchChild alloc] init];
+	_gchild = [[BenchGrandChild alloc] init];
+	_arr = [_base createBenchStringArray];
+	_dict = [_base createBenchDict];
+}
+
+- (void)tearDown
+{
+	_dict = nil;
+	_arr = nil;
+	_gchild = nil;
+	_child = nil;
+	_base = nil;
+}
+
+/* Section 1: Allocation */
+
+- (void)allocBase:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		BenchBase *obj = [[BenchBase alloc] init];
+		(void)obj;
+	}
+}
+
+- (void)allocChild:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		BenchChild *obj = [[BenchChild alloc] init];
+		(void)obj;
+	}
+}
+
+- (void)allocGrandChild:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		BenchGrandChild *obj = [[BenchGrandChild alloc] init];
+		(void)obj;
+	}
+}
+
+/* Section 2: Dispatch */
+
+- (void)staticDispatch:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		[_base nop];
+	}
+}
+
+- (void)classDispatch:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		[BenchBase classNop];
+	}
+}
+
+- (void)vtableDepth0:(int)n
+{
+	id<Benchable> poly = _base;
+
+	for (int i = 0; i < n; i++) {
+		[poly nop];
+	}
+}
+
+- (void)vtableDepth1:(int)n
+{
+	id<Benchable> poly = _child;
+
+	for (int i = 0; i < n; i++) {
+		[poly nop];
+	}
+}
+
+- (void)vtableDepth2:(int)n
+{
+	id<Benchable> poly = _gchild;
+
+	for (int i = 0; i < n; i++) {
+		[poly nop];
+	}
+}
+
+- (int)blockInvoke:(int)n
+{
+	int (^blk)(void) = ^{ return block_nop_fn(); };
+	int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		sum += blk();
+	}
+	return sum;
+}
+
+/* Section 3: Object Lifecycle (alloc + init + release is allocBase:) */
+
+- (void)allocRetainRelease:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		BenchBase *obj = [[BenchBase alloc] init];
+		BenchBase *extra = obj;
+		(void)extra;
+	}
+}
+
+/* Section 4: Reference Counting */
+
+- (void)retainRelease:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		BenchBase *copy = _base;
+		(void)copy;
+	}
+}
+
+/* Section 5: Properties / Synchronization */
+
+- (int)propertyGet:(int)n
+{
+	int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		sum += [_base value];
+	}
+	return sum;
+}
+
+- (void)propertySet:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		[_base setValue:i];
+	}
+}
+
+- (int)atomicPropertyGet:(int)n
+{
+	int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		sum += [_base atomicValue];
+	}
+	return sum;
+}
+
+- (void)atomicPropertySet:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		[_base setAtomicValue:i];
+	}
+}
+
+- (void)synchronizedEmpty:(int)n
+{
+	for (int i = 0; i < n; i++) {
+		[_base syncNop];
+	}
+}
+
+/* Section 6: Foundation Operations */
+
+- (unsigned int)arrayIndex:(int)n
+{
+	unsigned int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		OZString *str = [_arr objectAtIndex:5];
+		sum += [str length];
+	}
+	return sum;
+}
+
+- (unsigned int)arrayForIn:(int)n
+{
+	unsigned int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		for (OZString *str in _arr) {
+			sum += [str length];
+		}
+	}
+	return sum;
+}
+
+- (unsigned int)arrayLoop:(int)n
+{
+	unsigned int sum = 0;
+	unsigned int count = [_arr count];
+
+	for (int i = 0; i < n; i++) {
+		for (unsigned int j = 0; j < count; j++) {
+			OZString *str = [_arr objectAtIndex:j];
+			sum += [str length];
+		}
+	}
+	return sum;
+}
+
+- (unsigned int)dictLookup:(int)n
+{
+	OZString *key = @"bench_key";
+	unsigned int hits = 0;
+
+	for (int i = 0; i < n; i++) {
+		if ([_dict objectForKey:key] != nil) {
+			hits++;
+		}
+	}
+	return hits;
+}
+
+@end
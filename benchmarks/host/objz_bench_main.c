@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2025 Rodrigo Peixoto <rodrigopex@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Objective-Z host benchmark driver — times the BenchSuite kernels from
+ * objz_bench.m with oz_bench and checks every slab drained afterwards.
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+
+#include "oz_bench.h"
+#include "oz_dispatch.h"
+#include "BenchSuite_ozh.h"
+#include "BenchGrandChild_ozh.h"
+#include "OZString_ozh.h"
+#include "OZQ31_ozh.h"
+#include "OZArray_ozh.h"
+#include "OZDictionary_ozh.h"
+
+/* ── C baselines ──────────────────────────────────────────────────── */
+
+static void c_nop(void *self)
+{
+	(void)self;
+	__asm__ volatile("" ::: "memory");
+}
+
+/* Function pointer stored as global to prevent devirtualization */
+static void (*volatile c_nop_ptr)(void *) = c_nop;
+
+static void k_fn_ptr(void *ctx, int n)
+{
+	for (int i = 0; i < n; i++) {
+		c_nop_ptr(ctx);
+	}
+}
+
+static void k_raw_sum(void *ctx, int n)
+{
+	static const int32_t raw_arr[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	int32_t sum = 0;
+
+	(void)ctx;
+	for (int i = 0; i < n; i++) {
+		for (unsigned int j = 0; j < 10; j++) {
+			sum += *(volatile const int32_t *)&raw_arr[j];
+		}
+	}
+	oz_bench_sink += (uint64_t)sum;
+}
+
+/* ── BenchSuite kernels ───────────────────────────────────────────── */
+
+#define SUITE(ctx) ((struct BenchSuite *)(ctx))
+
+#define KERNEL_VOID(name, method)                                          \
+	static void name(void *ctx, int n)                                 \
+	{                                                                  \
+		method(SUITE(ctx), n);                                     \
+	}
+
+#define KERNEL_SINK(name, method)                                          \
+	static void name(void *ctx, int n)                                 \
+	{                                                                  \
+		oz_bench_sink += (uint64_t)method(SUITE(ctx), n);          \
+	}
+
+KERNEL_VOID(k_alloc_base, BenchSuite_allocBase_)
+KERNEL_VOID(k_alloc_child, BenchSuite_allocChild_)
+KERNEL_VOID(k_alloc_gchild, BenchSuite_allocGrandChild_)
+KERNEL_VOID(k_static, BenchSuite_staticDispatch_)
+KERNEL_VOID(k_class, BenchSuite_classDispatch_)
+KERNEL_VOID(k_vtable0, BenchSuite_vtableDepth0_)
+KERNEL_VOID(k_vtable1, BenchSuite_vtableDepth1_)
+KERNEL_VOID(k_vtable2, BenchSuite_vtableDepth2_)
+KERNEL_SINK(k_block, BenchSuite_blockInvoke_)
+KERNEL_VOID(k_alloc_retain, BenchSuite_allocRetainRelease_)
+KERNEL_VOID(k_retain_release, BenchSuite_retainRelease_)
+KERNEL_SINK(k_prop_get, BenchSuite_propertyGet_)
+KERNEL_VOID(k_prop_set, BenchSuite_propertySet_)
+KERNEL_SINK(k_atomic_get, BenchSuite_atomicPropertyGet_)
+KERNEL_VOID(k_atomic_set, BenchSuite_atomicPropertySet_)
+KERNEL_VOID(k_sync, BenchSuite_synchronizedEmpty_)
+KERNEL_SINK(k_index, BenchSuite_arrayIndex_)
+KERNEL_SINK(k_forin, BenchSuite_arrayForIn_)
+KERNEL_SINK(k_loop, BenchSuite_arrayLoop_)
+KERNEL_SINK(k_dict, BenchSuite_dictLookup_)
+
+/* ── Main ─────────────────────────────────────────────────────────── */
+
+int main(void)
+{
+	struct BenchSuite *suite = BenchSuite_alloc();
+
+	if (!suite) {
+		fprintf(stderr, "BenchSuite slab exhausted\n");
+		return 1;
+	}
+	OZ_PROTOCOL_SEND_init((struct OZObject *)suite);
+	BenchSuite_setUp(suite);
+
+	oz_bench_begin("objz");
+
+	oz_bench_section("1. Allocation");
+	oz_bench_run("alloc.base", "slab alloc + init + release (BenchBase)",
+		     SLOW_ITERATIONS, k_alloc_base, suite);
+	oz_bench_run("alloc.child", "slab alloc + init + release (BenchChild)",
+		     SLOW_ITERATIONS, k_alloc_child, suite);
+	oz_bench_run("alloc.grandchild",
+		     "slab alloc + init + release (GrandChild)",
+		     SLOW_ITERATIONS, k_alloc_gchild, suite);
+
+	oz_bench_section("2. Dispatch");
+	oz_bench_run("dispatch.fn_ptr", "C function pointer (baseline)",
+		     FAST_ITERATIONS, k_fn_ptr, suite);
+	oz_bench_run("dispatch.static", "Static dispatch [base nop]",
+		     FAST_ITERATIONS, k_static, suite);
+	oz_bench_run("dispatch.class", "Class method [BenchBase classNop]",
+		     FAST_ITERATIONS, k_class, suite);
+	oz_bench_run("dispatch.vtable0", "Vtable dispatch (depth=0)",
+		     ITERATIONS, k_vtable0, suite);
+	oz_bench_run("dispatch.vtable1", "Vtable dispatch (depth=1)",
+		     ITERATIONS, k_vtable1, suite);
+	oz_bench_run("dispatch.vtable2", "Vtable dispatch (depth=2)",
+		     ITERATIONS, k_vtable2, suite);
+	oz_bench_run("dispatch.block", "Block invocation (static fn ptr)",
+		     FAST_ITERATIONS, k_block, suite);
+
+	oz_bench_section("3. Object Lifecycle");
+	oz_bench_run("lifecycle.alloc_release", "alloc + init + release",
+		     SLOW_ITERATIONS, k_alloc_base, suite);
+	oz_bench_run("lifecycle.alloc_retain_release",
+		     "alloc + init + retain + 2x release",
+		     SLOW_ITERATIONS, k_alloc_retain, suite);
+
+	oz_bench_section("4. Reference Counting");
+	oz_bench_run("refcount.retain_release", "retain + release pair",
+		     ITERATIONS, k_retain_release, suite);
+
+	oz_bench_section("5. Properties / Synchronization");
+	oz_bench_run("props.get", "property get (nonatomic)",
+		     FAST_ITERATIONS, k_prop_get, suite);
+	oz_bench_run("props.set", "property set (nonatomic)",
+		     FAST_ITERATIONS, k_prop_set, suite);
+	oz_bench_run("props.atomic_get", "property get (atomic)",
+		     ITERATIONS, k_atomic_get, suite);
+	oz_bench_run("props.atomic_set", "property set (atomic)",
+		     ITERATIONS, k_atomic_set, suite);
+	oz_bench_run("sync.empty", "@synchronized (empty critical section)",
+		     ITERATIONS, k_sync, suite);
+
+	oz_bench_section("6. Foundation Operations");
+	oz_bench_run("foundation.raw_sum",
+		     "Raw int32_t[] sum (10 elems, baseline)",
+		     FAST_ITERATIONS, k_raw_sum, suite);
+	oz_bench_run("foundation.index",
+		     "OZArray objectAtIndex: (random access)",
+		     FAST_ITERATIONS, k_index, suite);
+	oz_bench_run("foundation.forin", "OZArray for-in (10 OZString, length)",
+		     ITERATIONS, k_forin, suite);
+	oz_bench_run("foundation.loop",
+		     "OZArray raw loop objectAtIndex: (10 str)",
+		     ITERATIONS, k_loop, suite);
+	oz_bench_run("foundation.dict_lookup",
+		     "OZDictionary objectForKey: (lookup)",
+		     ITERATIONS, k_dict, suite);
+
+	oz_bench_section("Object Sizes");
+	oz_bench_size("OZObject (class_id + refcount)", sizeof(struct OZObject));
+	oz_bench_size("BenchBase (OZObject + props + ivar)",
+		      sizeof(struct BenchBase));
+	oz_bench_size("BenchChild (BenchBase, no extra)",
+		      sizeof(struct BenchChild));
+	oz_bench_size("BenchGrandChild", sizeof(struct BenchGrandChild));
+	oz_bench_size("OZString", sizeof(struct OZString));
+	oz_bench_size("OZQ31", sizeof(struct OZQ31));
+	oz_bench_size("OZArray", sizeof(struct OZArray));
+	oz_bench_size("OZDictionary", sizeof(struct OZDictionary));
+	oz_bench_size("Pointer size", sizeof(void *));
+
+	int rc = oz_bench_end();
+
+	BenchSuite_tearDown(suite);
+	OZObject_release((struct OZObject *)suite);
+
+	rc |= oz_slab_check_leaks(&oz_slab_BenchSuite, "BenchSuite");
+	rc |= oz_slab_check_leaks(&oz_slab_BenchBase, "BenchBase");
+	rc |= oz_slab_check_leaks(&oz_slab_BenchChild, "BenchChild");
+	rc |= oz_slab_check_leaks(&oz_slab_BenchGrandChild, "BenchGrandChild");
+	return rc;
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2025 Rodrigo Peixoto <rodrigopex@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host benchmark harness — batch timing, median/p99, JSON report.
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "oz_bench.h"
+
+#define OZ_BENCH_MAX_RESULTS 64
+#define OZ_BENCH_MAX_SIZES   16
+#define OZ_BENCH_MAX_REPS    1001
+
+#if defined(__x86_64__) || defined(__i386__)
+#define OZ_BENCH_TIMER "rdtsc"
+#elif defined(__aarch64__)
+#define OZ_BENCH_TIMER "cntvct_el0"
+#else
+#define OZ_BENCH_TIMER "clock_gettime"
+#endif
+
+struct oz_bench_result {
+	const char *section;
+	const char *key;
+	const char *desc;
+	int iterations;
+	double median_cycles;
+	double p99_cycles;
+	double median_ns;
+	double p99_ns;
+};
+
+struct oz_bench_size_entry {
+	const char *desc;
+	size_t bytes;
+};
+
+volatile uint64_t oz_bench_sink;
+
+static const char *suite_name;
+static const char *current_section = "";
+static int reps = 31;
+static int warmup = 3;
+static uint64_t overhead_cycles;
+static uint64_t overhead_ns;
+
+static struct oz_bench_result results[OZ_BENCH_MAX_RESULTS];
+static int num_results;
+static struct oz_bench_size_entry sizes[OZ_BENCH_MAX_SIZES];
+static int num_sizes;
+
+static int env_int(const char *name, int fallback, int lo, int hi)
+{
+	const char *val = getenv(name);
+
+	if (!val || !*val) {
+		return fallback;
+	}
+	int n = atoi(val);
+
+	return n < lo ? lo : (n > hi ? hi : n);
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of an ascending array */
+static double percentile(const double *sorted, int n, int pct)
+{
+	int rank = (pct * n + 99) / 100;
+
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+/* Cheapest empty batch, with the timer reads nested as in oz_bench_run */
+static void calibrate_overhead(void)
+{
+	uint64_t best_cycles = UINT64_MAX;
+	uint64_t best_ns = UINT64_MAX;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		uint64_t t0 = oz_bench_ns();
+		uint64_t c0 = oz_bench_cycles();
+		uint64_t c1 = oz_bench_cycles();
+		uint64_t t1 = oz_bench_ns();
+
+		if (c1 - c0 < best_cycles) {
+			best_cycles = c1 - c0;
+		}
+		if (t1 - t0 < best_ns) {
+			best_ns = t1 - t0;
+		}
+	}
+	overhead_cycles = best_cycles;
+	overhead_ns = best_ns;
+}
+
+void oz_bench_begin(const char *suite)
+{
+	suite_name = suite;
+	reps = env_int("OZ_BENCH_REPS", reps, 1, OZ_BENCH_MAX_REPS);
+	warmup = env_int("OZ_BENCH_WARMUP", warmup, 0, 1000);
+	calibrate_overhead();
+
+	printf("=== %s host benchmark ===\n", suite);
+	printf("Timer: %s, reps=%d, warmup=%d, overhead=%llu cycles\n",
+	       OZ_BENCH_TIMER, reps, warmup,
+	       (unsigned long long)overhead_cycles);
+	printf("Iterations: fast=%d, normal=%d, slow=%d\n",
+	       FAST_ITERATIONS, ITERATIONS, SLOW_ITERATIONS);
+}
+
+void oz_bench_section(const char *title)
+{
+	current_section = title;
+	printf("\n--- %s ---\n", title);
+}
+
+static uint64_t minus_overhead(uint64_t total, uint64_t overhead)
+{
+	return total > overhead ? total - overhead : 0;
+}
+
+void oz_bench_run(const char *key, const char *desc, int iterations,
+		  oz_bench_fn fn, void *ctx)
+{
+	static double cycles[OZ_BENCH_MAX_REPS];
+	static double ns[OZ_BENCH_MAX_REPS];
+
+	if (num_results >= OZ_BENCH_MAX_RESULTS) {
+		fprintf(stderr, "oz_bench: too many results, '%s' dropped\n",
+			key);
+		return;
+	}
+	for (int i = 0; i < warmup; i++) {
+		fn(ctx, iterations);
+	}
+	for (int i = 0; i < reps; i++) {
+		uint64_t t0 = oz_bench_ns();
+		uint64_t c0 = oz_bench_cycles();
+
+		fn(ctx, iterations);
+
+		uint64_t c1 = oz_bench_cycles();
+		uint64_t t1 = oz_bench_ns();
+
+		cycles[i] = (double)minus_overhead(c1 - c0, overhead_cycles) /
+			    iterations;
+		ns[i] = (double)minus_overhead(t1 - t0, overhead_ns) /
+			iterations;
+	}
+	qsort(cycles, (size_t)reps, sizeof(double), cmp_double);
+	qsort(ns, (size_t)reps, sizeof(double), cmp_double);
+
+	struct oz_bench_result *r = &results[num_results++];
+
+	r->section = current_section;
+	r->key = key;
+	r->desc = desc;
+	r->iterations = iterations;
+	r->median_cycles = percentile(cycles, reps, 50);
+	r->p99_cycles = percentile(cycles, reps, 99);
+	r->median_ns = percentile(ns, reps, 50);
+	r->p99_ns = percentile(ns, reps, 99);
+
+	printf("  %-48s: %8.2f cycles (p99 %8.2f), %8.2f ns\n", desc,
+	       r->median_cycles, r->p99_cycles, r->median_ns);
+}
+
+void oz_bench_size(const char *desc, size_t bytes)
+{
+	if (num_sizes < OZ_BENCH_MAX_SIZES) {
+		sizes[num_sizes].desc = desc;
+		sizes[num_sizes].bytes = bytes;
+		num_sizes++;
+	}
+	printf("  %-48s: %5zu bytes\n", desc, bytes);
+}
+
+static void json_string(FILE *f, const char *s)
+{
+	fputc('"', f);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\') {
+			fputc('\\', f);
+		}
+		fputc(*s, f);
+	}
+	fputc('"', f);
+}
+
+static int write_json(const char *path)
+{
+	FILE *f = fopen(path, "w");
+
+	if (!f) {
+		perror(path);
+		return 1;
+	}
+	fprintf(f, "{\n  \"suite\": ");
+	json_string(f, suite_name);
+	fprintf(f, ",\n  \"timer\": \"%s\",\n  \"reps\": %d,\n"
+		   "  \"warmup\": %d,\n  \"results\": [",
+		OZ_BENCH_TIMER, reps, warmup);
+	for (int i = 0; i < num_results; i++) {
+		const struct oz_bench_result *r = &results[i];
+
+		fprintf(f, "%s\n    {\"section\": ", i ? "," : "");
+		json_string(f, r->section);
+		fprintf(f, ", \"key\": ");
+		json_string(f, r->key);
+		fprintf(f, ", \"desc\": ");
+		json_string(f, r->desc);
+		fprintf(f, ", \"iterations\": %d, \"median_cycles\": %.3f, "
+			   "\"p99_cycles\": %.3f, \"median_ns\": %.3f, "
+			   "\"p99_ns\": %.3f}",
+			r->iterations, r->median_cycles, r->p99_cycles,
+			r->median_ns, r->p99_ns);
+	}
+	fprintf(f, "\n  ],\n  \"sizes\": [");
+	for (int i = 0; i < num_sizes; i++) {
+		fprintf(f, "%s\n    {\"desc\": ", i ? "," : "");
+		json_string(f, sizes[i].desc);
+		fprintf(f, ", \"bytes\": %zu}", sizes[i].bytes);
+	}
+	fprintf(f, "\n  ]\n}\n");
+	return fclose(f) != 0;
+}
+
+int oz_bench_end(void)
+{
+	const char *path = getenv("OZ_BENCH_JSON");
+
+	printf("\n%d benchmarks\n", num_results);
+	if (path && *path) {
+		return write_json(path);
+	}
+	return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2025 Rodrigo Peixoto <rodrigopex@gmail.com>
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Host benchmark harness shared by the Objective-Z and C++ runners.
+ *
+ * Each benchmark is a kernel that performs one operation n times.  The
+ * harness runs it for OZ_BENCH_WARMUP untimed batches, then times
+ * OZ_BENCH_REPS batches with the cycle counter (rdtsc on x86, cntvct on
+ * AArch64, clock_gettime elsewhere) and CLOCK_MONOTONIC, and reports the
+ * median and p99 per-operation cost across batches.
+ *
+ * Environment:
+ *   OZ_BENCH_JSON    write the JSON report to this path
+ *   OZ_BENCH_REPS    timed batches per benchmark (default 31)
+ *   OZ_BENCH_WARMUP  untimed batches per benchmark (default 3)
+ */
+#ifndef OZ_BENCH_H
+#define OZ_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ── Iteration tiers (match benchmarks/objc and benchmarks/cpp) ───── */
+
+#define FAST_ITERATIONS  50000
+#define ITERATIONS       10000
+#define SLOW_ITERATIONS   1000
+
+/* ── Timers ───────────────────────────────────────────────────────── */
+
+static inline uint64_t oz_bench_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t oz_bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	uint32_t lo, hi;
+
+	__asm__ volatile("lfence\n\trdtsc" : "=a"(lo), "=d"(hi) : : "memory");
+	return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+	uint64_t val;
+
+	__asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(val) : : "memory");
+	return val;
+#else
+	return oz_bench_ns();
+#endif
+}
+
+/* ── Harness ──────────────────────────────────────────────────────── */
+
+/* Performs the measured operation n times; ctx is passed through */
+typedef void (*oz_bench_fn)(void *ctx, int n);
+
+/* Sink for kernel results so the optimiser cannot drop the work */
+extern volatile uint64_t oz_bench_sink;
+
+/*
+ * Per-iteration barrier for kernels whose work would otherwise inline to
+ * nothing: the lvalue v is treated as read and rewritten, and memory as
+ * clobbered, so each iteration must really load, store or call.
+ */
+#define OZ_BENCH_KEEP(v) __asm__ volatile("" : "+r"(v) : : "memory")
+
+void oz_bench_begin(const char *suite);
+void oz_bench_section(const char *title);
+
+/*
+ * Time fn and record it under key, a stable identifier shared by the
+ * Objective-Z and C++ runners so their reports can be joined.
+ */
+void oz_bench_run(const char *key, const char *desc, int iterations,
+		  oz_bench_fn fn, void *ctx);
+
+void oz_bench_size(const char *desc, size_t bytes);
+
+/* Print the summary and write the JSON report; returns 0 on success */
+int oz_bench_end(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OZ_BENCH_H */
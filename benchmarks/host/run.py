@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+"""Host benchmark runner: Objective-Z vs C++ side by side.
+
+Builds benchmarks/host/objz_bench.m through tests/tools/compile_and_run.py
+(--bench) and benchmarks/host/cpp/cpp_bench.cpp with the host C++ compiler,
+runs both, and joins their oz_bench JSON reports by benchmark key.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+HOST_DIR = Path(__file__).resolve().parent
+REPO_ROOT = HOST_DIR.parent.parent
+COMPILE_AND_RUN = REPO_ROOT / "tests" / "tools" / "compile_and_run.py"
+OBJZ_BENCH = HOST_DIR / "objz_bench.m"
+CPP_BENCH = HOST_DIR / "cpp" / "cpp_bench.cpp"
+CPP_CLASSES_DIR = REPO_ROOT / "benchmarks" / "cpp" / "src"
+
+
+def _run(cmd: list[str], env: dict | None = None,
+         cwd: Path | None = None) -> subprocess.CompletedProcess:
+    result = subprocess.run(cmd, capture_output=True, text=True, env=env,
+                            cwd=cwd)
+    if result.stdout:
+        print(result.stdout, end="")
+    if result.returncode != 0:
+        print(result.stderr, end="", file=sys.stderr)
+        raise SystemExit(f"error: {shlex.join(cmd[:3])} ... failed "
+                         f"(exit {result.returncode})")
+    return result
+
+
+def run_objz(out_json: Path, opt: str, compiler: str) -> dict:
+    """Transpile, build and run the Objective-Z benchmark."""
+    _run([sys.executable, str(COMPILE_AND_RUN), str(OBJZ_BENCH),
+          "--bench", f"--bench-json={out_json}",
+          "--opt", opt, "--compiler", compiler,
+          "--cflags=-DOZ_PLATFORM_HOST_MT", "--ldflags=-pthread"],
+         env={**os.environ, "PYTHONPATH": str(REPO_ROOT / "tools")},
+         cwd=REPO_ROOT)
+    return json.loads(out_json.read_text())
+
+
+def run_cpp(out_json: Path, opt: str, tmpdir: Path) -> dict:
+    """Build and run the C++ baseline (bench_classes.hpp on host)."""
+    cc = os.environ.get("CC", "gcc")
+    cxx = os.environ.get("CXX", "g++")
+    harness_obj = tmpdir / "oz_bench.o"
+    cpp_bin = tmpdir / "cpp_bench"
+    _run([cc, "-std=c11", f"-{opt}", "-Wall", "-Werror",
+          "-c", str(HOST_DIR / "oz_bench.c"), "-o", str(harness_obj)])
+    _run([cxx, "-std=c++17", f"-{opt}", "-Wall", "-Werror",
+          "-I", str(HOST_DIR), "-I", str(HOST_DIR / "cpp"),
+          "-I", str(CPP_CLASSES_DIR),
+          str(CPP_BENCH), str(harness_obj), "-o", str(cpp_bin)])
+    _run([str(cpp_bin)], env={**os.environ, "OZ_BENCH_JSON": str(out_json)})
+    return json.loads(out_json.read_text())
+
+
+def print_comparison(objz: dict | None, cpp: dict | None) -> None:
+    """Print median ns/op per key for both suites and their ratio."""
+    rows: dict[str, dict] = {}
+    order: list[str] = []
+    for suite, report in (("objz", objz), ("cpp", cpp)):
+        for r in (report or {}).get("results", []):
+            if r["key"] not in rows:
+                rows[r["key"]] = {}
+                order.append(r["key"])
+            rows[r["key"]][suite] = r
+
+    print(f"\n{'benchmark':<32} {'objz ns':>10} {'cpp ns':>10} {'objz/cpp':>9}")
+    for key in order:
+        o = rows[key].get("objz")
+        c = rows[key].get("cpp")
+        o_ns = f"{o['median_ns']:10.2f}" if o else f"{'-':>10}"
+        c_ns = f"{c['median_ns']:10.2f}" if c else f"{'-':>10}"
+        ratio = f"{'-':>9}"
+        if o and c and c["median_ns"] > 0:
+            ratio = f"{o['median_ns'] / c['median_ns']:9.2f}"
+        print(f"{key:<32} {o_ns} {c_ns} {ratio}")
+
+
+def main(argv: list[str] | None = None) -> int:
+    p = argparse.ArgumentParser(description="Host benchmarks: Objective-Z vs C++")
+    p.add_argument("--json", default=None, metavar="FILE",
+                   help="Write both reports to FILE as {\"objz\": ..., \"cpp\": ...}")
+    p.add_argument("--opt", default="O2", choices=["O0", "O2"],
+                   help="Optimization level for both builds (default: O2)")
+    p.add_argument("--compiler", default="gcc", choices=["gcc", "clang"],
+                   help="C compiler for the generated code (default: gcc)")
+    p.add_argument("--reps", type=int, default=None,
+                   help="Timed batches per benchmark (OZ_BENCH_REPS)")
+    p.add_argument("--warmup", type=int, default=None,
+                   help="Untimed batches per benchmark (OZ_BENCH_WARMUP)")
+    suites = p.add_mutually_exclusive_group()
+    suites.add_argument("--objz-only", action="store_true")
+    suites.add_argument("--cpp-only", action="store_true")
+    args = p.parse_args(argv)
+
+    if args.reps is not None:
+        os.environ["OZ_BENCH_REPS"] = str(args.reps)
+    if args.warmup is not None:
+        os.environ["OZ_BENCH_WARMUP"] = str(args.warmup)
+
+    objz = cpp = None
+    with tempfile.TemporaryDirectory(prefix="oz_bench_") as tmp:
+        tmpdir = Path(tmp)
+        if not args.cpp_only:
+            objz = run_objz(tmpdir / "objz.json", args.opt, args.compiler)
+        if not args.objz_only:
+            cpp = run_cpp(tmpdir / "cpp.json", args.opt, tmpdir)
+
+    print_comparison(objz, cpp)
+    if args.json:
+        report = {k: v for k, v in (("objz", objz), ("cpp", cpp)) if v}
+        Path(args.json).write_text(json.dumps(report, indent=2) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -20,7 +20,6 @@
 #include "OZQ31_ozh.h"
 #include "OZArray_ozh.h"
 #include "OZDictionary_ozh.h"
-#include "OZSpinLock_ozh.h"
 #include "mem_helpers_ozh.h"
 #include "MemChild_ozh.h"
 #include "MemGrandChild_ozh.h"
@@ -95,8 +94,8 @@ static void bench_foundation_sizes(void)
 	       sizeof(struct OZArray));
 	printk("  %-40s: %4zu bytes\n", "OZDictionary",
 	       sizeof(struct OZDictionary));
-	printk("  %-40s: %4zu bytes\n", "OZSpinLock",
-	       sizeof(struct OZSpinLock));
+	printk("  %-40s: %4zu bytes\n", "@synchronized lock stripe",
+	       sizeof(struct oz_sync_stripe));
 }
 
 /* ── Main ─────────────────────────────────────────────────────── */
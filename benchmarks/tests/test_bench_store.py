@@ -0,0 +1,96 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+from bench_store import compare  # noqa: E402
+
+
+def _result(host="Linux-x86_64", cycles=None, sizes=None):
+    result = {"commit": "abc", "host": host}
+    if cycles is not None:
+        result["bench"] = {"objz": {"results": [
+            {"key": key, "median_cycles": c} for key, c in cycles.items()]}}
+    if sizes is not None:
+        result["footprint"] = {"board": "nrf52833dk/nrf52833", "apps": [
+            {"name": name, "text": t, "data": d, "bss": b}
+            for name, (t, d, b) in sizes.items()]}
+    return result
+
+
+def _compare(baseline, current, cycles_tol=10.0, cycles_floor=1.0,
+             size_tol=0.0):
+    return compare(baseline, current, cycles_tol, cycles_floor, size_tol)
+
+
+class TestCycles:
+    def test_within_tolerance(self):
+        assert _compare(_result(cycles={"dispatch.static": 100.0}),
+                        _result(cycles={"dispatch.static": 109.0})) == []
+
+    def test_growth_beyond_tolerance(self):
+        regressions = _compare(_result(cycles={"dispatch.static": 100.0}),
+                               _result(cycles={"dispatch.static": 120.0}))
+        assert len(regressions) == 1
+        assert "objz/dispatch.static" in regressions[0]
+
+    def test_floor_ignores_tiny_absolute_growth(self):
+        assert _compare(_result(cycles={"dispatch.fn_ptr": 2.0}),
+                        _result(cycles={"dispatch.fn_ptr": 2.9})) == []
+
+    def test_missing_key_is_regression(self):
+        regressions = _compare(
+            _result(cycles={"dispatch.static": 10.0, "alloc.base": 50.0}),
+            _result(cycles={"dispatch.static": 10.0}))
+        assert regressions == ["objz/alloc.base: missing from current result"]
+
+    def test_new_key_is_not_regression(self):
+        assert _compare(_result(cycles={"a": 10.0}),
+                        _result(cycles={"a": 10.0, "b": 99.0})) == []
+
+    def test_different_hosts_not_compared(self):
+        with pytest.raises(SystemExit):
+            _compare(_result(host="Linux-x86_64", cycles={"a": 10.0}),
+                     _result(host="Darwin-arm64", cycles={"a": 99.0}))
+
+    def test_different_hosts_still_compare_footprint(self, capsys):
+        regressions = _compare(
+            _result(host="Linux-x86_64", cycles={"a": 10.0},
+                    sizes={"OZ speed": (1000, 10, 10)}),
+            _result(host="Darwin-arm64", cycles={"a": 99.0},
+                    sizes={"OZ speed": (1001, 10, 10)}))
+        assert regressions == [
+            "OZ speed text: 1000 -> 1001 bytes (+0.1%)"]
+        assert "across hosts" in capsys.readouterr().err
+
+
+class TestFootprint:
+    def test_unchanged(self):
+        sizes = {"OZ speed": (1000, 10, 20)}
+        assert _compare(_result(sizes=sizes), _result(sizes=sizes)) == []
+
+    def test_shrink_is_not_regression(self):
+        assert _compare(_result(sizes={"OZ speed": (1000, 10, 20)}),
+                        _result(sizes={"OZ speed": (900, 10, 20)})) == []
+
+    def test_size_tolerance(self):
+        base = _result(sizes={"OZ speed": (1000, 10, 20)})
+        cur = _result(sizes={"OZ speed": (1004, 10, 20)})
+        assert len(_compare(base, cur)) == 1
+        assert _compare(base, cur, size_tol=1.0) == []
+
+    def test_missing_app_is_regression(self):
+        regressions = _compare(
+            _result(sizes={"OZ speed": (1000, 10, 20),
+                           "C memory": (500, 4, 8)}),
+            _result(sizes={"OZ speed": (1000, 10, 20)}))
+        assert regressions == ["C memory: missing from current result"]
+
+
+def test_nothing_in_common():
+    with pytest.raises(SystemExit):
+        _compare(_result(cycles={"a": 1.0}), _result(sizes={"x": (1, 1, 1)}))
@@ -121,32 +121,59 @@ function(objz_transpile_sources target)
     set(_ast_dir ${CMAKE_CURRENT_BINARY_DIR}/oz_ast)
     set(_manifest ${_outdir}/oz_manifest.txt)
     set(_transpile_dir ${_mod}/tools)
+    set(_cache_dir ${_ast_dir}/cache)
 
     # ── Configure-time: AST dump + transpile to discover output files ──
+    # oz_transpile.astdump skips sources whose contents, headers (from
+    # clang -MD) and flags hash the same as at their last dump; the
+    # transpiler skips itself when none of its inputs changed and only
+    # rewrites generated files whose contents differ.
     set(_ast_files "")
     set(_abs_sources "")
     foreach(_src ${_sources})
         get_filename_component(_name ${_src} NAME)
         get_filename_component(_abs ${_src} ABSOLUTE)
         string(MAKE_C_IDENTIFIER "${_name}" _safe)
-        set(_ast "${_ast_dir}/${_safe}.ast.json")
-
-        file(MAKE_DIRECTORY ${_ast_dir})
-        execute_process(
-            COMMAND ${OBJZ_CLANG_COMPILER}
-                    ${_ast_flags}
-                    -fsyntax-only -Xclang -ast-dump=json
-                    ${_abs}
-            OUTPUT_FILE ${_ast}
-            ERROR_QUIET
-        )
-        list(APPEND _ast_files ${_ast})
+        list(APPEND _ast_files "${_ast_dir}/${_safe}.ast.json")
         list(APPEND _abs_sources ${_abs})
     endforeach()
 
+    file(MAKE_DIRECTORY ${_ast_dir})
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E env PYTHONPATH=${_transpile_dir}
+                ${Python3_EXECUTABLE} -m oz_transpile.astdump
+                --clang ${OBJZ_CLANG_COMPILER}
+                --sources ${_abs_sources}
+                --asts ${_ast_files}
+                -- ${_ast_flags}
+        ERROR_QUIET
+    )
+
     set(_pool_flag "")
+    set(_pool_profile "")
     if(OZT_POOL_SIZES)
-        set(_pool_flag "--pool-sizes=${OZT_POOL_SIZES}")
+        list(APPEND _pool_flag "--pool-sizes=${OZT_POOL_SIZES}")
+    endif()
+    if(CONFIG_OBJZ_POOL_STATS)
+        list(APPEND _pool_flag "--pool-stats")
+    endif()
+    if(NOT "${CONFIG_OBJZ_POOL_PROFILE}" STREQUAL "")
+        get_filename_component(_pool_profile ${CONFIG_OBJZ_POOL_PROFILE}
+                               ABSOLUTE BASE_DIR ${CMAKE_SOURCE_DIR})
+        list(APPEND _pool_flag "--pool-profile=${_pool_profile}"
+                               "--pool-margin=${CONFIG_OBJZ_POOL_MARGIN}")
+    endif()
+    if(NOT "${CONFIG_OBJZ_MSTRING_MAX_SIZE}" STREQUAL "")
+        list(APPEND _pool_flag
+             "--mstring-max-size=${CONFIG_OBJZ_MSTRING_MAX_SIZE}")
+    endif()
+
+    set(_log_flag "")
+    if(CONFIG_OBJZ_LOG_SPECIALIZE)
+        set(_log_flag "--log-specialize")
+    endif()
+    if(CONFIG_OBJZ_LOG_DEFERRED)
+        list(APPEND _log_flag "--log-deferred")
     endif()
 
     set(_heap_flag "")
@@ -154,6 +181,35 @@ function(objz_transpile_sources target)
         set(_heap_flag "--heap-support")
     endif()
 
+    set(_arc_flag "")
+    if(CONFIG_OBJZ_ARC_OPTIMIZE)
+        list(APPEND _arc_flag "--arc-optimize")
+    endif()
+    if(NOT "${CONFIG_OBJZ_NONATOMIC_RC}" STREQUAL "")
+        list(APPEND _arc_flag "--nonatomic-rc=${CONFIG_OBJZ_NONATOMIC_RC}")
+    endif()
+    if(CONFIG_OBJZ_DEFERRED_DEALLOC)
+        list(APPEND _arc_flag "--deferred-dealloc")
+    endif()
+    if(CONFIG_OBJZ_DEFERRED_RELEASE)
+        list(APPEND _arc_flag
+             "--deferred-release=${CONFIG_OBJZ_DEFERRED_RELEASE_CLASSES}")
+    endif()
+
+    set(_dispatch_flag "")
+    set(_profile "")
+    if(CONFIG_OBJZ_COMPACT_DISPATCH)
+        list(APPEND _dispatch_flag "--compact-dispatch")
+    endif()
+    if(CONFIG_OBJZ_DEVIRTUALIZE)
+        list(APPEND _dispatch_flag "--devirtualize")
+    endif()
+    if(NOT "${CONFIG_OBJZ_DISPATCH_PROFILE}" STREQUAL "")
+        get_filename_component(_profile ${CONFIG_OBJZ_DISPATCH_PROFILE}
+                               ABSOLUTE BASE_DIR ${CMAKE_SOURCE_DIR})
+        list(APPEND _dispatch_flag "--dispatch-guards=${_profile}")
+    endif()
+
     file(MAKE_DIRECTORY ${_outdir})
     execute_process(
         COMMAND ${CMAKE_COMMAND} -E env PYTHONPATH=${_transpile_dir}
@@ -163,9 +219,13 @@ function(objz_transpile_sources target)
                 --outdir ${_outdir}
                 --root-class=${OZT_ROOT_CLASS}
                 --manifest=${_manifest}
+                --cache-dir=${_cache_dir}
                 --verbose
                 ${_pool_flag}
                 ${_heap_flag}
+                ${_arc_flag}
+                ${_dispatch_flag}
+                ${_log_flag}
         RESULT_VARIABLE _rc
     )
     if(NOT _rc EQUAL 0)
@@ -179,21 +239,25 @@ function(objz_transpile_sources target)
     set(_stamp ${_outdir}/.oz_transpile.stamp)
 
 
-    # Build a shell script to AST-dump each source then run the transpiler.
-    # Clang stderr is captured per-source; shown only on transpiler failure.
+    # Build a shell script to AST-dump the changed sources then run the
+    # transpiler.  Clang stderr is captured per-source (<name>.err.log next
+    # to each dump); shown only on transpiler failure.
     set(_script "${_ast_dir}/oz_transpile_build.sh")
     set(_script_lines "#!/bin/sh\nset -e\n")
     set(_err_logs "")
     foreach(_src ${_abs_sources})
         get_filename_component(_name ${_src} NAME)
         string(MAKE_C_IDENTIFIER "${_name}" _safe)
-        set(_ast "${_ast_dir}/${_safe}.ast.json")
-        set(_err "${_ast_dir}/${_safe}.err.log")
-        string(JOIN " " _ast_cmd ${OBJZ_CLANG_COMPILER} ${_ast_flags}
-               -fsyntax-only -Xclang -ast-dump=json ${_src})
-        string(APPEND _script_lines "${_ast_cmd} > ${_ast} 2>${_err} || true\n")
-        list(APPEND _err_logs ${_err})
+        list(APPEND _err_logs "${_ast_dir}/${_safe}.err.log")
     endforeach()
+    string(JOIN " " _ast_cmd
+           PYTHONPATH=${_transpile_dir}
+           ${Python3_EXECUTABLE} -m oz_transpile.astdump
+           --clang ${OBJZ_CLANG_COMPILER}
+           --sources ${_abs_sources}
+           --asts ${_ast_files}
+           -- ${_ast_flags})
+    string(APPEND _script_lines "${_ast_cmd}\n")
     string(JOIN " " _transpile_cmd
            PYTHONPATH=${_transpile_dir}
            ${Python3_EXECUTABLE} -m oz_transpile
@@ -202,9 +266,13 @@ function(objz_transpile_sources target)
            --outdir ${_outdir}
            --root-class=${OZT_ROOT_CLASS}
            --manifest=${_manifest}
+           --cache-dir=${_cache_dir}
            --verbose
            ${_pool_flag}
-           ${_heap_flag})
+           ${_heap_flag}
+           ${_arc_flag}
+           ${_dispatch_flag}
+           ${_log_flag})
     # Run transpiler; on failure dump Clang error logs for diagnosis
     string(JOIN " " _err_logs_str ${_err_logs})
     string(APPEND _script_lines
@@ -215,7 +283,7 @@ function(objz_transpile_sources target)
         OUTPUT  ${_stamp} ${_gen_files}
         COMMAND sh ${_script}
         COMMAND ${CMAKE_COMMAND} -E touch ${_stamp}
-        DEPENDS ${_abs_sources}
+        DEPENDS ${_abs_sources} ${_profile} ${_pool_profile}
         COMMENT "oz_transpile: generating C from ObjC"
     )
 
@@ -238,6 +306,9 @@ function(objz_transpile_sources target)
     if(CONFIG_OBJZ_HEAP)
         target_compile_definitions(${target} PRIVATE OZ_HEAP_SUPPORT)
     endif()
+    if(CONFIG_OBJZ_NONATOMIC_RC_CHECK)
+        target_compile_definitions(${target} PRIVATE OZ_NONATOMIC_RC_CHECK)
+    endif()
 
     # Add OZLog support (pure C, uses generated oz_dispatch.h for %@)
     target_sources(${target} PRIVATE ${_mod}/src/OZLog.c)
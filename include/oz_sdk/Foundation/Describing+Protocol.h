@@ -0,0 +1,21 @@
+#import "OZObject.h"
+
+/**
+ * @brief Description with per-call formatting options.
+ *
+ * OZLog sends this instead of -cDescription:maxLength: for %.N@ when the
+ * object's class conforms, so the precision travels as an argument and
+ * concurrent loggers never share formatting state.
+ */
+@protocol DescribingProtocol
+
+@required
+/**
+ * @brief Write a description of at most @p maxLen bytes into @p buf.
+ *
+ * @p precision is the number of fractional digits (-1: class default).
+ * Returns bytes written.
+ */
+- (int)cDescription:(char *)buf maxLength:(int)maxLen precision:(int)precision;
+
+@end
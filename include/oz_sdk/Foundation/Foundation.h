@@ -17,5 +17,5 @@
 #import "OZDefer.h"
 #import "OZTimer.h"
 #import "OZLog.h"
-#import "OZSpinLock.h"
 #import "Singleton+Protocol.h"
+#import "Describing+Protocol.h"
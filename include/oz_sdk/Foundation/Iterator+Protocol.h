@@ -1,11 +1,32 @@
 #import "OZObject.h"
 
+/**
+ * @brief Caller-owned cursor for for-in enumeration.
+ *
+ * The transpiler stack-allocates one per loop, so nested loops and
+ * concurrent readers never share iteration state.  @c state is 0 on the
+ * first call; collections use it (and @c extra) to remember their
+ * position between batches.  Mirrored for the generated C in
+ * platform/oz_platform_types.h.
+ */
+struct NSFastEnumerationState {
+	unsigned long state;
+	__unsafe_unretained id *itemsPtr;
+	unsigned long *mutationsPtr;
+	unsigned long extra[5];
+};
+
 @protocol IteratorProtocol
 
 @required
-@property (nonatomic, readonly) uint16_t iterIdx;
-
-- (instancetype)iter;
-- (id)next;
+/**
+ * @brief Return the next batch of objects.
+ *
+ * Point @c state->itemsPtr at up to @p len objects (either internal
+ * storage or @p stackbuf) and return how many there are; 0 ends the loop.
+ */
+- (unsigned long)countByEnumeratingWithState:(struct NSFastEnumerationState *)state
+				     objects:(__unsafe_unretained id *)stackbuf
+				       count:(unsigned long)len;
 
 @end
@@ -9,16 +9,11 @@
 #import "OZObject.h"
 #import "Iterator+Protocol.h"
 
-struct NSFastEnumerationState;
-
 @interface OZArray<__covariant ObjectType> : OZObject <IteratorProtocol> {
 	__unsafe_unretained id *_items;
 	unsigned int _count;
-	uint16_t _iterIdx;
 }
 
-@property (readonly) uint16_t iterIdx;
-
 + (id)arrayWithObjects:(const id *)objects count:(unsigned int)count;
 - (unsigned int)count;
 - (id)objectAtIndex:(unsigned int)index;
@@ -28,8 +23,6 @@ struct NSFastEnumerationState;
 				     objects:(__unsafe_unretained id *)stackbuf
 				       count:(unsigned long)len;
 - (int)cDescription:(char *)buf maxLength:(int)maxLen;
-- (instancetype)iter;
-- (id)next;
 @end
 
 @compatibility_alias NSArray OZArray;
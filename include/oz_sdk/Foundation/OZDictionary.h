@@ -4,34 +4,34 @@
  *
  * Lightweight ObjC interface that Clang can parse for AST dump.
  * The transpiler emits pure-C static dictionary constants.
+ *
+ * Lookups go through an open-addressed table of key slots (@c _index,
+ * entries are slot + 1, 0 is empty) sized to a power of two with
+ * @c _mask = capacity - 1.  A NULL @c _index falls back to a linear scan.
  */
 #pragma once
 #import "OZObject.h"
 #import "Iterator+Protocol.h"
 
-struct NSFastEnumerationState;
-
 @interface OZDictionary<__covariant KeyType, __covariant ObjectType> : OZObject <IteratorProtocol> {
 	__unsafe_unretained id *_keys;
 	__unsafe_unretained id *_values;
 	unsigned int _count;
-	uint16_t _iterIdx;
+	uint16_t *_index;
+	uint16_t _mask;
 }
 
-@property (readonly) uint16_t iterIdx;
-
 + (id)dictionaryWithObjects:(const id *)objects
 		    forKeys:(const id *)keys
 		      count:(unsigned int)count;
 - (unsigned int)count;
 - (id)objectForKey:(id)key;
 - (id)objectForKeyedSubscript:(id)key;
+- (void)buildIndex;
 - (unsigned long)countByEnumeratingWithState:(struct NSFastEnumerationState *)state
 				     objects:(__unsafe_unretained id *)stackbuf
 				       count:(unsigned long)len;
 - (int)cDescription:(char *)buf maxLength:(int)maxLen;
-- (instancetype)iter;
-- (id)next;
 @end
 
 @compatibility_alias NSDictionary OZDictionary;
@@ -2,19 +2,50 @@
  * @file OZMutableString.h
  * @brief Mutable string class for OZ transpiler.
  *
- * Heap-allocated dynamic string that inherits from OZString.
- * Buffer grows via capacity doubling when needed.
+ * Dynamic string that inherits from OZString.  Contents up to 23
+ * characters live in an inline buffer inside the object; longer
+ * contents move to a buffer from the size-classed string slabs
+ * (32 bytes up to CONFIG_OBJZ_MSTRING_MAX_SIZE, 256 by default,
+ * generated in oz_dispatch.c and sized with POOL_SIZES
+ * "OZMutableString.<bytes>=N" or a pool profile), or from the
+ * OZHeap passed to -initWithCapacity:heap:.  Capacity doubles
+ * when it grows.  No libc malloc is involved.
+ *
+ * Growth fails when no buffer fits (contents of the largest size
+ * class or more without an OZHeap, or an exhausted pool): the
+ * append/set methods then return NO and leave the string as it was.
  */
 #pragma once
 #import "OZString.h"
 
+/**
+ * @brief Size-classed buffer allocator for OZMutableString.
+ *
+ * Takes the smallest string slab class that fits *capacity and
+ * rounds *capacity up to it; with a non-nil heap (an OZHeap) the
+ * buffer comes from that heap instead.  Returns NULL when nothing
+ * fits.  Defined in the generated oz_dispatch.c.
+ */
+char *oz_mstring_buf_alloc(id heap, unsigned int *capacity);
+
+/** @brief Return a buffer from oz_mstring_buf_alloc(). */
+void oz_mstring_buf_free(id heap, char *buf, unsigned int capacity);
+
 @interface OZMutableString : OZString {
 	unsigned int _capacity;
+	id _heap;
+	char _inline[24];
 }
 - (id)initWithCString:(const char *)str;
 - (id)initWithString:(OZString *)aString;
 - (id)initWithCapacity:(unsigned int)capacity;
-- (void)appendString:(OZString *)aString;
-- (void)appendCString:(const char *)str;
-- (void)setString:(OZString *)aString;
+- (id)initWithCapacity:(unsigned int)capacity heap:(id)heap;
+- (BOOL)reserveCapacity:(unsigned int)capacity;
+- (unsigned int)capacity;
+/** @return NO (string unchanged) when no buffer fits the result. */
+- (BOOL)appendString:(OZString *)aString;
+/** @return NO (string unchanged) when no buffer fits the result. */
+- (BOOL)appendCString:(const char *)str;
+/** @return NO (string unchanged) when no buffer fits aString. */
+- (BOOL)setString:(OZString *)aString;
 @end
@@ -53,7 +53,12 @@ __attribute__((objc_root_class))
 - (instancetype)init;
 - (void)dealloc;
 - (BOOL)isEqual:(id)anObject;
+- (unsigned int)hash;
 - (int)cDescription:(char *)buf maxLength:(int)maxLen;
+#ifdef CONFIG_OBJZ_LOG_DEFERRED
+/** Compact %@ payload for the deferred log; decoded by logdecode.py */
+- (int)encode:(uint8_t *)buf maxLength:(int)maxLen;
+#endif
 @end
 
 #ifdef __clang__
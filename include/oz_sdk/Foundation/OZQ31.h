@@ -10,8 +10,9 @@
  */
 #pragma once
 #import "OZObject.h"
+#import "Describing+Protocol.h"
 
-@interface OZQ31 : OZObject {
+@interface OZQ31 : OZObject <DescribingProtocol> {
 	int32_t _raw;    /* Q31 mantissa, normalised to [-1.0, 1.0) */
 	uint8_t _shift;  /* exponent: real_value = (raw / 2^31) * 2^shift */
 }
@@ -59,7 +60,12 @@
 
 /* OZObject overrides */
 - (int)cDescription:(char *)buf maxLength:(int)maxLen;
+- (int)cDescription:(char *)buf maxLength:(int)maxLen precision:(int)precision;
 - (BOOL)isEqual:(id)anObject;
+- (unsigned int)hash;
+#ifdef CONFIG_OBJZ_LOG_DEFERRED
+- (int)encode:(uint8_t *)buf maxLength:(int)maxLen;
+#endif
 @end
 
 #ifdef __clang__
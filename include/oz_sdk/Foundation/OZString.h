@@ -16,10 +16,14 @@
 - (const char *)cString;
 - (unsigned int)length;
 - (BOOL)isEqual:(id)anObject;
+- (unsigned int)hash;
 - (BOOL)isEqualToString:(OZString *)aString;
 - (BOOL)hasPrefix:(OZString *)prefix;
 - (BOOL)hasSuffix:(OZString *)suffix;
 - (int)cDescription:(char *)buf maxLength:(int)maxLen;
+#ifdef CONFIG_OBJZ_LOG_DEFERRED
+- (int)encode:(uint8_t *)buf maxLength:(int)maxLen;
+#endif
 @end
 
 #ifdef __clang__
@@ -18,5 +18,6 @@ typedef bool BOOL;
 @protocol ObjectProtocol
 @required
 - (BOOL)isEqual:(id)anObject;
+- (unsigned int)hash;
 - (int)cDescription:(char *)buf maxLength:(int)maxLen;
 @end
@@ -1,13 +1,52 @@
-/* OZSpinLock — RAII spinlock for @synchronized support */
+/* @synchronized support — striped recursive spinlocks keyed by object */
 #pragma once
 
+#include <stdint.h>
 #include "oz_platform.h"
 
-struct OZObject;
+#ifdef CONFIG_OBJZ_SYNC_LOCK_STRIPES
+#define OZ_SYNC_LOCK_STRIPES CONFIG_OBJZ_SYNC_LOCK_STRIPES
+#else
+#define OZ_SYNC_LOCK_STRIPES 16
+#endif
 
-struct OZSpinLock {
-	struct OZObject base;
-	oz_spinlock_t _lock;
-	oz_spinlock_key_t _key;
-	struct OZObject *_obj;
+/*
+ * One stripe of the @synchronized lock table.  owner and depth are only
+ * written by the thread holding lock; owner is cleared before unlocking so
+ * a thread can never observe itself as a stale owner.  Other threads peek
+ * at owner without the lock, so it is accessed with relaxed atomics.
+ */
+struct oz_sync_stripe {
+	oz_spinlock_t lock;
+	oz_spinlock_key_t key;
+	oz_thread_id_t owner;
+	unsigned int depth;
 };
+
+/* Defined in the generated oz_dispatch.c when @synchronized is used */
+extern struct oz_sync_stripe oz_sync_stripes[OZ_SYNC_LOCK_STRIPES];
+
+static inline struct oz_sync_stripe *oz_sync_enter(const void *obj)
+{
+	uintptr_t addr = (uintptr_t)obj;
+	struct oz_sync_stripe *s =
+		&oz_sync_stripes[((addr >> 4) ^ (addr >> 12)) % OZ_SYNC_LOCK_STRIPES];
+
+	if (oz_thread_is_self(__atomic_load_n(&s->owner, __ATOMIC_RELAXED))) {
+		s->depth++;
+		return s;
+	}
+	oz_spinlock_key_t key = oz_spin_lock(&s->lock);
+	s->key = key;
+	__atomic_store_n(&s->owner, oz_thread_self(), __ATOMIC_RELAXED);
+	s->depth = 1;
+	return s;
+}
+
+static inline void oz_sync_exit(struct oz_sync_stripe *s)
+{
+	if (--s->depth == 0) {
+		__atomic_store_n(&s->owner, (oz_thread_id_t)0, __ATOMIC_RELAXED);
+		oz_spin_unlock(&s->lock, s->key);
+	}
+}
@@ -6,47 +6,212 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
 #include "oz_platform_types.h"
 
 /* ------------------------------------------------------------------ */
-/* Slab allocator — malloc-backed with block-count tracking            */
+/* Spinlock — no-op by default, real with OZ_PLATFORM_HOST_MT          */
 /* ------------------------------------------------------------------ */
 
+#ifdef OZ_PLATFORM_HOST_MT
+
+/*
+ * Test-and-set lock on a C11 atomic rather than pthread_spinlock_t, so
+ * that zero-filled storage (object ivars, file-scope statics) is an
+ * unlocked lock, as with struct k_spinlock.  Waiters yield after a few
+ * hundred spins since, unlike k_spin_lock, the holder can be preempted.
+ */
+typedef struct {
+        atomic_int locked;
+} oz_spinlock_t;
+typedef int oz_spinlock_key_t;
+
+static inline oz_spinlock_key_t oz_spin_lock(oz_spinlock_t *lck)
+{
+        unsigned int spins = 0;
+
+        while (atomic_exchange_explicit(&lck->locked, 1,
+                                        memory_order_acquire)) {
+                while (atomic_load_explicit(&lck->locked,
+                                            memory_order_relaxed)) {
+                        if (++spins % 256 == 0) {
+                                sched_yield();
+                        }
+                }
+        }
+        return 0;
+}
+
+static inline void oz_spin_unlock(oz_spinlock_t *lck, oz_spinlock_key_t key)
+{
+        (void)key;
+        atomic_store_explicit(&lck->locked, 0, memory_order_release);
+}
+
+#define OZ_SPINLOCK(lck)                                                       \
+        for (oz_spinlock_key_t _oz_key = oz_spin_lock(lck), _oz_once = 1;      \
+             _oz_once; oz_spin_unlock(lck, _oz_key), _oz_once = 0)
+
+#else /* !OZ_PLATFORM_HOST_MT */
+
+typedef int oz_spinlock_t;
+typedef int oz_spinlock_key_t;
+#define OZ_SPINLOCK(lck) if ((void)(lck), 1)
+
+static inline oz_spinlock_key_t oz_spin_lock(oz_spinlock_t *lck)
+{
+        (void)lck;
+        return 0;
+}
+
+static inline void oz_spin_unlock(oz_spinlock_t *lck, oz_spinlock_key_t key)
+{
+        (void)lck;
+        (void)key;
+}
+
+#endif /* OZ_PLATFORM_HOST_MT */
+
+/* ------------------------------------------------------------------ */
+/* AddressSanitizer hooks — keep free slab/pool blocks poisoned        */
+/* ------------------------------------------------------------------ */
+
+#if defined(__SANITIZE_ADDRESS__)
+#define OZ_HOST_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define OZ_HOST_ASAN 1
+#endif
+#endif
+
+#ifdef OZ_HOST_ASAN
+#include <sanitizer/asan_interface.h>
+#define OZ_HOST_POISON(addr, size)   ASAN_POISON_MEMORY_REGION(addr, size)
+#define OZ_HOST_UNPOISON(addr, size) ASAN_UNPOISON_MEMORY_REGION(addr, size)
+#else
+#define OZ_HOST_POISON(addr, size)   ((void)(addr), (void)(size))
+#define OZ_HOST_UNPOISON(addr, size) ((void)(addr), (void)(size))
+#endif
+
+/* Round up to a multiple of the pointer size, like Zephyr's WB_UP() */
+#define OZ_HOST_WB_UP(x)                                                       \
+        (((x) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+/* ------------------------------------------------------------------ */
+/* Slab allocator — fixed-block free list over a static buffer         */
+/* ------------------------------------------------------------------ */
+
+/*
+ * Mirrors k_mem_slab: each OZ_SLAB_DEFINE reserves n_blocks blocks of
+ * WB_UP(blk_size) bytes in a buffer aligned to WB_UP(alignment), and
+ * free blocks are chained through their first word.  The free list is
+ * built on first use (Zephyr builds it at boot), lowest address first.
+ * max_used is the high-water mark, as with MEM_SLAB_TRACE_MAX_UTILIZATION.
+ */
 struct oz_slab {
+        oz_spinlock_t lock;
+        char *buffer;
+        char *free_list;
         size_t block_size;
         uint32_t num_blocks;
         uint32_t num_used;
+        uint32_t max_used;
+        bool initialized;
 };
 
 typedef struct oz_slab oz_slab_t;
 
 #define OZ_SLAB_DEFINE(name, blk_size, n_blocks, alignment)                    \
+        static _Alignas(OZ_HOST_WB_UP(alignment)) char                         \
+                _oz_slab_buf_##name[(n_blocks) * OZ_HOST_WB_UP(blk_size)];     \
         oz_slab_t name = {                                                     \
-                .block_size = (blk_size),                                      \
+                .buffer = _oz_slab_buf_##name,                                 \
+                .free_list = NULL,                                             \
+                .block_size = OZ_HOST_WB_UP(blk_size),                         \
                 .num_blocks = (n_blocks),                                      \
-                .num_used = 0                                                  \
+                .num_used = 0,                                                 \
+                .max_used = 0,                                                 \
+                .initialized = false                                           \
         }
 
+static inline void oz_slab_init_free_list(oz_slab_t *slab)
+{
+        char *p = slab->buffer + slab->block_size * slab->num_blocks;
+
+        slab->free_list = NULL;
+        for (uint32_t i = 0; i < slab->num_blocks; i++) {
+                p -= slab->block_size;
+                *(char **)p = slab->free_list;
+                slab->free_list = p;
+                OZ_HOST_POISON(p + sizeof(char *),
+                               slab->block_size - sizeof(char *));
+        }
+        slab->initialized = true;
+}
+
 static inline int oz_slab_alloc(oz_slab_t *slab, void **mem)
 {
-        if (slab->num_used >= slab->num_blocks) {
-                *mem = NULL;
-                return OZ_ENOMEM;
+        oz_spinlock_key_t key = oz_spin_lock(&slab->lock);
+
+        if (!slab->initialized) {
+                oz_slab_init_free_list(slab);
         }
-        *mem = malloc(slab->block_size);
-        if (!*mem) {
-                return OZ_ENOMEM;
+        char *block = slab->free_list;
+
+        if (block) {
+                slab->free_list = *(char **)block;
+                OZ_HOST_UNPOISON(block, slab->block_size);
+                slab->num_used++;
+                if (slab->num_used > slab->max_used) {
+                        slab->max_used = slab->num_used;
+                }
         }
-        slab->num_used++;
-        return OZ_OK;
+        oz_spin_unlock(&slab->lock, key);
+        *mem = block;
+        return block ? OZ_OK : OZ_ENOMEM;
 }
 
 static inline void oz_slab_free(oz_slab_t *slab, void *mem)
 {
-        free(mem);
+        char *block = mem;
+
+        if (!block) {
+                return;
+        }
+        oz_spinlock_key_t key = oz_spin_lock(&slab->lock);
+
+        *(char **)block = slab->free_list;
+        slab->free_list = block;
+        OZ_HOST_POISON(block + sizeof(char *),
+                       slab->block_size - sizeof(char *));
         if (slab->num_used > 0) {
                 slab->num_used--;
         }
+        oz_spin_unlock(&slab->lock, key);
+}
+
+static inline uint32_t oz_slab_num_used(oz_slab_t *slab)
+{
+        oz_spinlock_key_t key = oz_spin_lock(&slab->lock);
+        uint32_t n = slab->num_used;
+
+        oz_spin_unlock(&slab->lock, key);
+        return n;
+}
+
+static inline uint32_t oz_slab_max_used(oz_slab_t *slab)
+{
+        oz_spinlock_key_t key = oz_spin_lock(&slab->lock);
+        uint32_t n = slab->max_used;
+
+        oz_spin_unlock(&slab->lock, key);
+        return n;
+}
+
+static inline uint32_t oz_slab_num_blocks(oz_slab_t *slab)
+{
+        return slab->num_blocks;
 }
 
 /* ------------------------------------------------------------------ */
@@ -69,60 +234,135 @@ static inline int oz_slab_check_leaks(oz_slab_t *slab, const char *name)
 }
 
 /* ------------------------------------------------------------------ */
-/* Contiguous block allocator — malloc-backed for OZArray/OZDictionary */
+/* Contiguous block allocator — first-fit bitmap over a static buffer  */
 /* ------------------------------------------------------------------ */
 
+/*
+ * Mirrors sys_mem_blocks: n_blocks blocks of blk_size bytes in a buffer
+ * aligned to WB_UP(alignment), one bit per block.  A run of count
+ * blocks is taken from the lowest free range that fits, so a pool with
+ * enough free blocks can still fail with OZ_ENOMEM when fragmented.
+ */
 struct oz_mem_blocks {
+        oz_spinlock_t lock;
+        uint8_t *buffer;
+        uint32_t *bitmap;
         size_t block_size;
         uint32_t num_blocks;
         uint32_t num_used;
+        bool initialized;
 };
 
 typedef struct oz_mem_blocks oz_mem_blocks_t;
 
 #define OZ_MEM_BLOCKS_DEFINE(name, blk_size, n_blocks, alignment)              \
+        static _Alignas(OZ_HOST_WB_UP(alignment)) uint8_t                      \
+                _oz_mem_blocks_buf_##name[(n_blocks) * (blk_size)];            \
+        static uint32_t _oz_mem_blocks_bits_##name[((n_blocks) + 31) / 32];    \
         oz_mem_blocks_t name = {                                               \
+                .buffer = _oz_mem_blocks_buf_##name,                           \
+                .bitmap = _oz_mem_blocks_bits_##name,                          \
                 .block_size = (blk_size),                                      \
                 .num_blocks = (n_blocks),                                      \
-                .num_used = 0                                                  \
+                .num_used = 0,                                                 \
+                .initialized = false                                           \
         }
 
-static inline int oz_mem_blocks_alloc_contiguous(oz_mem_blocks_t *pool,
-                                                 uint32_t count, void **mem)
+static inline bool oz_mem_blocks_test_bit(const oz_mem_blocks_t *pool,
+                                          uint32_t bit)
 {
-        if (pool->num_used + count > pool->num_blocks) {
-                *mem = NULL;
-                return OZ_ENOMEM;
+        return (pool->bitmap[bit / 32] >> (bit % 32)) & 1U;
+}
+
+static inline void oz_mem_blocks_set_bits(oz_mem_blocks_t *pool,
+                                          uint32_t first, uint32_t count,
+                                          bool set)
+{
+        for (uint32_t bit = first; bit < first + count; bit++) {
+                if (set) {
+                        pool->bitmap[bit / 32] |= 1U << (bit % 32);
+                } else {
+                        pool->bitmap[bit / 32] &= ~(1U << (bit % 32));
+                }
         }
-        *mem = malloc(pool->block_size * count);
-        if (!*mem) {
+}
+
+static inline int oz_mem_blocks_find_run(oz_mem_blocks_t *pool,
+                                         uint32_t count, void **mem)
+{
+        if (!pool->initialized) {
+                memset(pool->bitmap, 0,
+                       ((pool->num_blocks + 31) / 32) * sizeof(uint32_t));
+                OZ_HOST_POISON(pool->buffer,
+                               pool->block_size * pool->num_blocks);
+                pool->initialized = true;
+        }
+        *mem = NULL;
+        if (count == 0) {
+                return OZ_OK;
+        }
+        if (count > pool->num_blocks - pool->num_used) {
                 return OZ_ENOMEM;
         }
-        pool->num_used += count;
-        return OZ_OK;
+
+        uint32_t run = 0;
+
+        for (uint32_t bit = 0; bit < pool->num_blocks; bit++) {
+                run = oz_mem_blocks_test_bit(pool, bit) ? 0 : run + 1;
+                if (run == count) {
+                        uint32_t first = bit + 1 - count;
+
+                        oz_mem_blocks_set_bits(pool, first, count, true);
+                        pool->num_used += count;
+                        *mem = pool->buffer + (size_t)first * pool->block_size;
+                        OZ_HOST_UNPOISON(*mem, pool->block_size * count);
+                        return OZ_OK;
+                }
+        }
+        return OZ_ENOMEM;
+}
+
+static inline int oz_mem_blocks_alloc_contiguous(oz_mem_blocks_t *pool,
+                                                 uint32_t count, void **mem)
+{
+        oz_spinlock_key_t key = oz_spin_lock(&pool->lock);
+        int rc = oz_mem_blocks_find_run(pool, count, mem);
+
+        oz_spin_unlock(&pool->lock, key);
+        return rc;
 }
 
 static inline void oz_mem_blocks_free_contiguous(oz_mem_blocks_t *pool,
                                                  void *mem, uint32_t count)
 {
-        free(mem);
+        if (!mem || count == 0) {
+                return;
+        }
+        uint32_t first = (uint32_t)(((uint8_t *)mem - pool->buffer) /
+                                    pool->block_size);
+        oz_spinlock_key_t key = oz_spin_lock(&pool->lock);
+
+        oz_mem_blocks_set_bits(pool, first, count, false);
+        OZ_HOST_POISON(mem, pool->block_size * count);
         if (pool->num_used >= count) {
                 pool->num_used -= count;
         }
+        oz_spin_unlock(&pool->lock, key);
 }
 
 /* ------------------------------------------------------------------ */
 /* Atomic integers — C11 stdatomic                                     */
 /* ------------------------------------------------------------------ */
 
-typedef _Atomic(int) oz_atomic_t;
+/* long, like Zephyr's atomic_t, so the slot is always pointer-width */
+typedef _Atomic(long) oz_atomic_t;
 
-static inline void oz_atomic_init(oz_atomic_t *target, int val)
+static inline void oz_atomic_init(oz_atomic_t *target, long val)
 {
         atomic_store(target, val);
 }
 
-static inline int oz_atomic_inc(oz_atomic_t *target)
+static inline long oz_atomic_inc(oz_atomic_t *target)
 {
         return atomic_fetch_add(target, 1) + 1;
 }
@@ -132,31 +372,104 @@ static inline bool oz_atomic_dec_and_test(oz_atomic_t *target)
         return atomic_fetch_sub(target, 1) == 1;
 }
 
-static inline int oz_atomic_get(oz_atomic_t *target)
+static inline long oz_atomic_get(oz_atomic_t *target)
 {
         return atomic_load(target);
 }
 
+static inline void oz_atomic_set(oz_atomic_t *target, long val)
+{
+        atomic_store(target, val);
+}
+
+static inline bool oz_atomic_cas(oz_atomic_t *target, long old, long val)
+{
+        return atomic_compare_exchange_strong(target, &old, val);
+}
+
+/*
+ * Non-atomic refcount ops for thread-confined objects: relaxed load and
+ * store compile to a plain increment/decrement without a locked RMW.
+ */
+static inline long oz_nonatomic_inc(oz_atomic_t *target)
+{
+        long val = atomic_load_explicit(target, memory_order_relaxed) + 1;
+        atomic_store_explicit(target, val, memory_order_relaxed);
+        return val;
+}
+
+static inline bool oz_nonatomic_dec_and_test(oz_atomic_t *target)
+{
+        long val = atomic_load_explicit(target, memory_order_relaxed) - 1;
+        atomic_store_explicit(target, val, memory_order_relaxed);
+        return val == 0;
+}
+
+/* Dead object's refcount slot reused as a deferred-dealloc list link */
+static inline void oz_atomic_set_link(oz_atomic_t *target, void *next)
+{
+        atomic_store_explicit(target, (long)(uintptr_t)next,
+                              memory_order_relaxed);
+}
+
+static inline void *oz_atomic_get_link(oz_atomic_t *target)
+{
+        return (void *)(uintptr_t)atomic_load_explicit(target,
+                                                       memory_order_relaxed);
+}
+
+/* Word-sized field atomics for lock-free atomic property accessors */
+#define oz_atomic_load_field(ptr, out) __atomic_load((ptr), (out), __ATOMIC_ACQUIRE)
+#define oz_atomic_store_field(ptr, val) __atomic_store((ptr), (val), __ATOMIC_RELEASE)
+
+static inline void *oz_atomic_ptr_swap(void **target, void *val)
+{
+        return __atomic_exchange_n(target, val, __ATOMIC_ACQ_REL);
+}
+
+static inline bool oz_atomic_ptr_cas(void **target, void *old, void *val)
+{
+        return __atomic_compare_exchange_n(target, &old, val, false,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
 /* ------------------------------------------------------------------ */
-/* Spinlock — no-op on host (single-threaded tests)                    */
+/* Deferred work — no workqueue on host: submissions are counted and   */
+/* tests run the handler (or the drain it wraps) explicitly            */
 /* ------------------------------------------------------------------ */
 
-typedef int oz_spinlock_t;
-typedef int oz_spinlock_key_t;
-#define OZ_SPINLOCK(lck) if ((void)(lck), 1)
+struct oz_work {
+        void (*handler)(struct oz_work *work);
+        atomic_uint submitted;
+};
 
-static inline oz_spinlock_key_t oz_spin_lock(oz_spinlock_t *lck)
+typedef struct oz_work oz_work_t;
+
+#define OZ_WORK_DEFINE(name, fn) oz_work_t name = { .handler = (fn) }
+
+static inline void oz_work_submit(oz_work_t *work)
 {
-        (void)lck;
-        return 0;
+        atomic_fetch_add(&work->submitted, 1);
 }
 
-static inline void oz_spin_unlock(oz_spinlock_t *lck, oz_spinlock_key_t key)
+/* ------------------------------------------------------------------ */
+/* Thread identity — pthread_self for thread-confinement checks        */
+/* ------------------------------------------------------------------ */
+
+typedef pthread_t oz_thread_id_t;
+
+static inline oz_thread_id_t oz_thread_self(void)
 {
-        (void)lck;
-        (void)key;
+        return pthread_self();
 }
 
+static inline bool oz_thread_is_self(oz_thread_id_t tid)
+{
+        return pthread_equal(tid, pthread_self()) != 0;
+}
+
+#define OZ_THREAD_LOCAL _Thread_local
+
 /* ------------------------------------------------------------------ */
 /* Formatted output — printf                                           */
 /* ------------------------------------------------------------------ */
@@ -26,14 +26,52 @@
  *   [10]   heap_allocated — object lives in an OZHeap / system heap
  *   [11]   deallocating   — re-entrant dealloc guard
  *   [12]   immortal       — skip dealloc (singletons, literals)
- *   [13:31] reserved
+ *   [13]   thread_confined — non-atomic refcount (--nonatomic-rc)
+ *   [14]   deferred_release — dealloc on the release workqueue (--deferred-release)
+ *   [15:31] reserved
  */
 struct oz_metadata {
         uint32_t class_id        : 10;
         uint32_t heap_allocated  :  1;
         uint32_t deallocating    :  1;
         uint32_t immortal        :  1;
-        uint32_t reserved        : 19;
+        uint32_t thread_confined :  1;
+        uint32_t deferred_release:  1;
+        uint32_t reserved        : 17;
 };
 
+/** @brief Objects finalised per deferred-dealloc drain (--deferred-dealloc). */
+#ifndef OZ_DEALLOC_DRAIN_BATCH
+#ifdef CONFIG_OBJZ_DEFERRED_DEALLOC_BATCH
+#define OZ_DEALLOC_DRAIN_BATCH CONFIG_OBJZ_DEFERRED_DEALLOC_BATCH
+#else
+#define OZ_DEALLOC_DRAIN_BATCH 16
+#endif
+#endif
+
+/* ------------------------------------------------------------------ */
+/* for-in cursor — C mirror of Foundation/Iterator+Protocol.h         */
+/* ------------------------------------------------------------------ */
+
+struct OZObject;
+
+/**
+ * @brief Stack-allocated enumeration cursor passed to
+ *        countByEnumeratingWithState:objects:count:.
+ *
+ * Lives in the caller's frame, one per for-in loop, so iteration keeps
+ * no state inside the collection.
+ */
+struct NSFastEnumerationState {
+        unsigned long state;
+        struct OZObject **itemsPtr;
+        unsigned long *mutationsPtr;
+        unsigned long extra[5];
+};
+
+/** @brief Objects per batch a for-in loop offers in its stack buffer. */
+#ifndef OZ_FORIN_BATCH
+#define OZ_FORIN_BATCH 4
+#endif
+
 #endif /* OZ_PLATFORM_TYPES_H */
@@ -27,6 +27,26 @@ static inline void oz_slab_free(oz_slab_t *slab, void *mem)
         k_mem_slab_free(slab, mem);
 }
 
+static inline uint32_t oz_slab_num_used(oz_slab_t *slab)
+{
+        return k_mem_slab_num_used_get(slab);
+}
+
+/* High-water mark (current usage without MEM_SLAB_TRACE_MAX_UTILIZATION) */
+static inline uint32_t oz_slab_max_used(oz_slab_t *slab)
+{
+#ifdef CONFIG_MEM_SLAB_TRACE_MAX_UTILIZATION
+        return k_mem_slab_max_used_get(slab);
+#else
+        return k_mem_slab_num_used_get(slab);
+#endif
+}
+
+static inline uint32_t oz_slab_num_blocks(oz_slab_t *slab)
+{
+        return slab->info.num_blocks;
+}
+
 /* ------------------------------------------------------------------ */
 /* Contiguous block allocator — sys_mem_blocks pass-through            */
 /* ------------------------------------------------------------------ */
@@ -74,6 +94,99 @@ static inline atomic_val_t oz_atomic_get(oz_atomic_t *target)
         return atomic_get(target);
 }
 
+static inline void oz_atomic_set(oz_atomic_t *target, atomic_val_t val)
+{
+        (void)atomic_set(target, val);
+}
+
+static inline bool oz_atomic_cas(oz_atomic_t *target, atomic_val_t old,
+                                 atomic_val_t val)
+{
+        return atomic_cas(target, old, val);
+}
+
+/*
+ * Non-atomic refcount ops for thread-confined objects: plain
+ * increment/decrement instead of an LDREX/STREX loop.
+ */
+static inline atomic_val_t oz_nonatomic_inc(oz_atomic_t *target)
+{
+        return ++(*target);
+}
+
+static inline bool oz_nonatomic_dec_and_test(oz_atomic_t *target)
+{
+        return --(*target) == 0;
+}
+
+/*
+ * Deferred dealloc: once an object's refcount reaches zero its slot
+ * (atomic_t is a long, i.e. pointer-width) links it into the pending list.
+ */
+static inline void oz_atomic_set_link(oz_atomic_t *target, void *next)
+{
+        atomic_set(target, (atomic_val_t)(uintptr_t)next);
+}
+
+static inline void *oz_atomic_get_link(oz_atomic_t *target)
+{
+        return (void *)(uintptr_t)atomic_get(target);
+}
+
+/*
+ * Word-sized field atomics for lock-free atomic property accessors.
+ * Aligned loads/stores up to pointer width are single instructions;
+ * the pointer swap goes through atomic_ptr_set (LDREX/STREX or the
+ * kernel's C fallback on cores without exclusives).
+ */
+#define oz_atomic_load_field(ptr, out) __atomic_load((ptr), (out), __ATOMIC_ACQUIRE)
+#define oz_atomic_store_field(ptr, val) __atomic_store((ptr), (val), __ATOMIC_RELEASE)
+
+static inline void *oz_atomic_ptr_swap(void **target, void *val)
+{
+        return atomic_ptr_set((atomic_ptr_t *)target, val);
+}
+
+static inline bool oz_atomic_ptr_cas(void **target, void *old, void *val)
+{
+        return atomic_ptr_cas((atomic_ptr_t *)target, old, val);
+}
+
+/* ------------------------------------------------------------------ */
+/* Deferred work — k_work on the system workqueue                      */
+/* ------------------------------------------------------------------ */
+
+typedef struct k_work oz_work_t;
+
+#define OZ_WORK_DEFINE(name, handler) K_WORK_DEFINE(name, handler)
+
+static inline void oz_work_submit(oz_work_t *work)
+{
+        (void)k_work_submit(work);
+}
+
+/* ------------------------------------------------------------------ */
+/* Thread identity — k_current_get for thread-confinement checks       */
+/* ------------------------------------------------------------------ */
+
+typedef k_tid_t oz_thread_id_t;
+
+static inline oz_thread_id_t oz_thread_self(void)
+{
+        return k_current_get();
+}
+
+static inline bool oz_thread_is_self(oz_thread_id_t tid)
+{
+        return tid == k_current_get();
+}
+
+#ifdef CONFIG_THREAD_LOCAL_STORAGE
+#define OZ_THREAD_LOCAL __thread
+#else
+#define OZ_THREAD_LOCAL
+#endif
+
 /* ------------------------------------------------------------------ */
 /* Spinlock — scoped preemption guard for atomic property accessors     */
 /* ------------------------------------------------------------------ */
@@ -4,8 +4,6 @@
 
 @implementation OZArray
 
-@synthesize iterIdx = _iterIdx;
-
 - (unsigned int)count
 {
 	return _count;
@@ -52,20 +50,19 @@
 	}
 }
 
-- (instancetype)iter {
-	_iterIdx = 0;
-	return self;
-}
-- (id)next {
-	if (_iterIdx >= _count) {
-		return nil;
+- (unsigned long)countByEnumeratingWithState:(struct NSFastEnumerationState *)state
+				     objects:(__unsafe_unretained id *)stackbuf
+				       count:(unsigned long)len
+{
+	(void)stackbuf;
+	(void)len;
+	/* Items are contiguous: hand them all out in one batch */
+	if (state->state != 0) {
+		return 0;
 	}
-
-	id ret = _items[_iterIdx];
-
-	_iterIdx++;
-
-	return ret;
+	state->state = 1;
+	state->itemsPtr = _items;
+	return _count;
 }
 
 @end
@@ -1,25 +1,23 @@
 /* Immutable dictionary implementation for OZ transpiler samples. */
 
 #import <Foundation/OZDictionary.h>
+#include <stddef.h>
 
 @implementation OZDictionary
 
-@synthesize iterIdx = _iterIdx;
-
-- (instancetype)iter
+- (unsigned long)countByEnumeratingWithState:(struct NSFastEnumerationState *)state
+				     objects:(__unsafe_unretained id *)stackbuf
+				       count:(unsigned long)len
 {
-	_iterIdx = 0;
-	return self;
-}
-
-- (id)next
-{
-	if (_iterIdx >= _count) {
-		return nil;
+	(void)stackbuf;
+	(void)len;
+	/* Keys are contiguous: hand them all out in one batch */
+	if (state->state != 0) {
+		return 0;
 	}
-	id ret = _keys[_iterIdx];
-	_iterIdx++;
-	return ret;
+	state->state = 1;
+	state->itemsPtr = _keys;
+	return _count;
 }
 
 - (unsigned int)count
@@ -29,15 +27,42 @@
 
 - (id)objectForKey:(id)key
 {
-	for (unsigned int i = 0; i < _count; i++) {
+	if (key == nil) {
+		return nil;
+	}
+	if (_index == NULL) {
+		for (unsigned int i = 0; i < _count; i++) {
+			id k = _keys[i];
+			if ([k isEqual:key]) {
+				return _values[i];
+			}
+		}
+		return nil;
+	}
+	unsigned int slot = [key hash] & _mask;
+	while (_index[slot] != 0) {
+		unsigned int i = _index[slot] - 1;
 		id k = _keys[i];
 		if ([k isEqual:key]) {
 			return _values[i];
 		}
+		slot = (slot + 1) & _mask;
 	}
 	return nil;
 }
 
+- (void)buildIndex
+{
+	for (unsigned int i = 0; i < _count; i++) {
+		id k = _keys[i];
+		unsigned int slot = [k hash] & _mask;
+		while (_index[slot] != 0) {
+			slot = (slot + 1) & _mask;
+		}
+		_index[slot] = (uint16_t)(i + 1);
+	}
+}
+
 - (id)objectForKeyedSubscript:(id)key
 {
 	return [self objectForKey:key];
@@ -10,8 +10,13 @@
  * Pure C implementation of OZLog() for transpiled builds.
  * Uses OZ_PROTOCOL_SEND_cDescription_maxLength_() for %@ (const vtable dispatch).
  * Zero heap allocation — everything on the stack.
+ *
+ * With CONFIG_OBJZ_LOG_SPECIALIZE the transpiler lowers OZLog() calls
+ * with a literal format to per-call-site functions built from the
+ * oz_log_*() writers below, so the hot path never parses the format.
  */
 #include <stdarg.h>
+#include <string.h>
 #include <zephyr/sys/printk.h>
 
 #include "oz_dispatch.h"
@@ -21,11 +26,33 @@
 #define CONFIG_OBJZ_LOG_BUFFER_SIZE 128
 #endif
 
-static int _oz_log_precision = -1;
-
-int _oz_get_log_precision(void)
+/*
+ * Write obj's description (or "(nil)") into buf; returns bytes written.
+ * A %.N@ precision goes to DescribingProtocol classes as an argument, so
+ * formatting keeps no shared state and is safe from any thread.
+ */
+static int log_object(char *buf, int room, struct OZObject *obj, int prec)
 {
-	return _oz_log_precision;
+	if (obj == NULL) {
+		int n = 0;
+		const char *s = "(nil)";
+
+		while (*s && n < room) {
+			buf[n++] = *s++;
+		}
+		return n;
+	}
+
+#ifdef OZ_PROTOCOL_SEND_cDescription_maxLength_precision_
+	if (prec >= 0 &&
+	    oz_conformsTo(obj->_meta.class_id, OZ_PROTO_DescribingProtocol)) {
+		return OZ_PROTOCOL_SEND_cDescription_maxLength_precision_(obj, buf, room,
+									   prec);
+	}
+#else
+	(void)prec;
+#endif
+	return OZ_PROTOCOL_SEND_cDescription_maxLength_(obj, buf, room);
 }
 
 void OZLog(const char *fmt, ...)
@@ -72,17 +99,7 @@ void OZLog(const char *fmt, ...)
 
 			if (*p == '@') {
 				struct OZObject *obj = va_arg(args, struct OZObject *);
-				if (obj == NULL) {
-					const char *s = "(nil)";
-					while (*s && pos < max) {
-						buf[pos++] = *s++;
-					}
-				} else {
-					_oz_log_precision = obj_prec;
-					pos += OZ_PROTOCOL_SEND_cDescription_maxLength_(
-						obj, buf + pos, max - pos);
-					_oz_log_precision = -1;
-				}
+				pos += log_object(buf + pos, max - pos, obj, obj_prec);
 				p++;
 				continue;
 			}
@@ -230,3 +247,96 @@ void OZLog(const char *fmt, ...)
 
 	printk("%s\n", buf);
 }
+
+#ifdef CONFIG_OBJZ_LOG_SPECIALIZE
+
+#define LOG_ROOM(b) ((int)sizeof((b)->data) - 1 - (b)->pos)
+
+void oz_log_lit(struct oz_log_buf *b, const char *s, int len)
+{
+	int room = LOG_ROOM(b);
+
+	if (len > room) {
+		len = room;
+	}
+	memcpy(b->data + b->pos, s, len);
+	b->pos += len;
+}
+
+void oz_log_str(struct oz_log_buf *b, const char *s)
+{
+	if (s == NULL) {
+		s = "(null)";
+	}
+	oz_log_lit(b, s, (int)strlen(s));
+}
+
+void oz_log_char(struct oz_log_buf *b, int c)
+{
+	if (LOG_ROOM(b) > 0) {
+		b->data[b->pos++] = (char)c;
+	}
+}
+
+void oz_log_uint(struct oz_log_buf *b, unsigned int v)
+{
+	char tmp[10];
+	int n = sizeof(tmp);
+
+	do {
+		tmp[--n] = (char)('0' + v % 10U);
+		v /= 10U;
+	} while (v != 0U);
+	oz_log_lit(b, tmp + n, (int)sizeof(tmp) - n);
+}
+
+void oz_log_int(struct oz_log_buf *b, int v)
+{
+	if (v < 0) {
+		oz_log_char(b, '-');
+		oz_log_uint(b, 0U - (unsigned int)v);
+		return;
+	}
+	oz_log_uint(b, (unsigned int)v);
+}
+
+void oz_log_hex(struct oz_log_buf *b, unsigned int v, int upper)
+{
+	const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+	char tmp[8];
+	int n = sizeof(tmp);
+
+	do {
+		tmp[--n] = digits[v & 0xfU];
+		v >>= 4;
+	} while (v != 0U);
+	oz_log_lit(b, tmp + n, (int)sizeof(tmp) - n);
+}
+
+void oz_log_obj(struct oz_log_buf *b, const void *obj, int prec)
+{
+	b->pos += log_object(b->data + b->pos, LOG_ROOM(b),
+			     (struct OZObject *)obj, prec);
+}
+
+void oz_log_fmt(struct oz_log_buf *b, const char *spec, ...)
+{
+	va_list args;
+	int room = LOG_ROOM(b);
+	int n;
+
+	va_start(args, spec);
+	n = vsnprintk(b->data + b->pos, room + 1, spec, args);
+	va_end(args);
+	if (n > 0) {
+		b->pos += n < room ? n : room;
+	}
+}
+
+void oz_log_end(struct oz_log_buf *b)
+{
+	b->data[b->pos] = '\0';
+	printk("%s\n", b->data);
+}
+
+#endif /* CONFIG_OBJZ_LOG_SPECIALIZE */
@@ -1,7 +1,9 @@
-/* Mutable string implementation for OZ transpiler. */
+/* Mutable string implementation for OZ transpiler.
+ *
+ * Short contents stay in _inline; longer ones live in a buffer from
+ * oz_mstring_buf_alloc() (string slabs, or _heap when one was given). */
 
 #import <Foundation/OZMutableString.h>
-#include <stdlib.h>
 #include <string.h>
 
 #ifndef NULL
@@ -13,27 +15,14 @@
 - (id)initWithCString:(const char *)str
 {
 	self = [super init];
-	if (str == NULL) {
-		unsigned int cap = 16;
-		char *buf = (char *)malloc(cap);
-		if (buf == NULL) {
-			return nil;
-		}
-		buf[0] = '\0';
-		_data = buf;
-		_length = 0;
-		_capacity = cap;
-	} else {
-		unsigned int len = (unsigned int)strlen(str);
-		unsigned int cap = len < 16 ? 16 : len * 2;
-		char *buf = (char *)malloc(cap);
-		if (buf == NULL) {
+	if (![self reserveCapacity:0]) {
+		return nil;
+	}
+	if (str != NULL) {
+		[self appendCString:str];
+		if (_length != (unsigned int)strlen(str)) {
 			return nil;
 		}
-		memcpy(buf, str, len + 1);
-		_data = buf;
-		_length = len;
-		_capacity = cap;
 	}
 	return self;
 }
@@ -49,83 +38,112 @@
 - (id)initWithCapacity:(unsigned int)capacity
 {
 	self = [super init];
-	unsigned int cap = capacity < 16 ? 16 : capacity;
-	char *buf = (char *)malloc(cap);
-	if (buf == NULL) {
+	if (![self reserveCapacity:capacity]) {
+		return nil;
+	}
+	return self;
+}
+
+- (id)initWithCapacity:(unsigned int)capacity heap:(id)heap
+{
+	self = [super init];
+	_heap = heap;
+	if (![self reserveCapacity:capacity]) {
 		return nil;
 	}
-	buf[0] = '\0';
-	_data = buf;
-	_length = 0;
-	_capacity = cap;
 	return self;
 }
 
-- (void)appendCString:(const char *)str
+- (BOOL)reserveCapacity:(unsigned int)capacity
+{
+	if (_data == NULL) {
+		_data = _inline;
+		_capacity = sizeof(_inline);
+	}
+	if (capacity <= _capacity) {
+		return YES;
+	}
+	unsigned int newCap = _capacity * 2;
+	if (newCap < capacity) {
+		newCap = capacity;
+	}
+	char *newBuf = oz_mstring_buf_alloc(_heap, &newCap);
+	if (newBuf == NULL) {
+		return NO;
+	}
+	memcpy(newBuf, _data, _length + 1);
+	if (_data != _inline) {
+		oz_mstring_buf_free(_heap, (char *)_data, _capacity);
+	}
+	_data = newBuf;
+	_capacity = newCap;
+	return YES;
+}
+
+- (unsigned int)capacity
+{
+	return _capacity;
+}
+
+- (BOOL)appendCString:(const char *)str
 {
 	if (str == NULL) {
-		return;
+		return YES;
 	}
 	unsigned int addLen = (unsigned int)strlen(str);
 	if (addLen == 0) {
-		return;
+		return YES;
 	}
+	/* str may point into our own buffer, which growth moves */
+	const char *base = _data;
+	BOOL aliased = base != NULL && str >= base && str < base + _capacity;
+	unsigned int offset = aliased ? (unsigned int)(str - base) : 0;
 	unsigned int newLen = _length + addLen;
-	if (newLen + 1 > _capacity) {
-		unsigned int newCap = _capacity;
-		while (newCap < newLen + 1) {
-			newCap = newCap * 2;
-		}
-		char *newBuf = (char *)malloc(newCap);
-		if (newBuf == NULL) {
-			return;
-		}
-		memcpy(newBuf, _data, _length);
-		free((void *)_data);
-		_data = newBuf;
-		_capacity = newCap;
+	if (![self reserveCapacity:newLen + 1]) {
+		return NO;
+	}
+	if (aliased) {
+		str = _data + offset;
 	}
-	memcpy((char *)_data + _length, str, addLen + 1);
+	memmove((char *)_data + _length, str, addLen + 1);
 	_length = newLen;
+	_hash = 0;
+	return YES;
 }
 
-- (void)appendString:(OZString *)aString
+- (BOOL)appendString:(OZString *)aString
 {
 	if (aString == nil) {
-		return;
+		return YES;
 	}
-	[self appendCString:[aString cString]];
+	return [self appendCString:[aString cString]];
 }
 
-- (void)setString:(OZString *)aString
+- (BOOL)setString:(OZString *)aString
 {
-	if (aString == nil) {
-		((char *)_data)[0] = '\0';
-		_length = 0;
-		return;
-	}
-	const char *src = [aString cString];
-	unsigned int len = [aString length];
-	if (len + 1 > _capacity) {
-		unsigned int newCap = _capacity;
-		while (newCap < len + 1) {
-			newCap = newCap * 2;
-		}
-		char *newBuf = (char *)malloc(newCap);
-		if (newBuf == NULL) {
-			return;
-		}
-		free((void *)_data);
-		_data = newBuf;
-		_capacity = newCap;
+	const char *src = "";
+	unsigned int len = 0;
+	if (aString != nil) {
+		src = [aString cString];
+		len = [aString length];
+	}
+	if (src == _data) {
+		return YES;
 	}
-	memcpy((void *)_data, src, len + 1);
+	if (![self reserveCapacity:len + 1]) {
+		return NO;
+	}
+	memcpy((char *)_data, src, len + 1);
 	_length = len;
+	_hash = 0;
+	return YES;
 }
 
 - (void)dealloc
 {
-	free((void *)_data);
+	if (_data != NULL && _data != _inline) {
+		oz_mstring_buf_free(_heap, (char *)_data, _capacity);
+	}
 }
 
 @end
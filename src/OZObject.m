@@ -18,8 +18,18 @@
 {
 	return self == anObject;
 }
+- (unsigned int)hash
+{
+	return (unsigned int)((uintptr_t)self >> 3);
+}
 - (int)cDescription:(char *)buf maxLength:(int)maxLen
 {
 	return 0;
 }
+#ifdef CONFIG_OBJZ_LOG_DEFERRED
+- (int)encode:(uint8_t *)buf maxLength:(int)maxLen
+{
+	return 0;
+}
+#endif
 @end
@@ -1,7 +1,6 @@
 /* Fixed-point (Q31+shift) implementation for OZ transpiler. */
 
 #import <Foundation/OZQ31.h>
-#import <Foundation/OZLog.h>
 
 #ifndef _OZ_Q31_HELPERS
 #define _OZ_Q31_HELPERS
@@ -503,13 +502,36 @@ static inline void _oz_q31_div(int32_t a_raw, uint8_t a_shift,
 
 - (int)cDescription:(char *)buf maxLength:(int)maxLen
 {
-	int prec = _oz_get_log_precision();
-	if (prec < 0) {
-		prec = 14;
+	return _oz_q31_to_str(_raw, _shift, buf, maxLen, 14);
+}
+
+/* DescribingProtocol: %.N@ in OZLog */
+- (int)cDescription:(char *)buf maxLength:(int)maxLen precision:(int)precision
+{
+	if (precision < 0) {
+		precision = 14;
 	}
-	return _oz_q31_to_str(_raw, _shift, buf, maxLen, prec);
+	return _oz_q31_to_str(_raw, _shift, buf, maxLen, precision);
 }
 
+#ifdef CONFIG_OBJZ_LOG_DEFERRED
+/* <raw int32, little-endian><shift u8>, formatted off-target like
+ * cDescription (default precision) */
+- (int)encode:(uint8_t *)buf maxLength:(int)maxLen
+{
+	if (maxLen < 5) {
+		return 0;
+	}
+	uint32_t raw = (uint32_t)_raw;
+
+	for (int i = 0; i < 4; i++) {
+		buf[i] = (uint8_t)(raw >> (8 * i));
+	}
+	buf[4] = _shift;
+	return 5;
+}
+#endif
+
 - (BOOL)isEqual:(id)anObject
 {
 	if (self == anObject) {
@@ -519,6 +541,11 @@ static inline void _oz_q31_div(int32_t a_raw, uint8_t a_shift,
 	return (_raw == other->_raw) && (_shift == other->_shift);
 }
 
+- (unsigned int)hash
+{
+	return ((unsigned int)_raw * 2654435761u) ^ (unsigned int)_shift;
+}
+
 - (void)dealloc
 {
 	/* OZQ31 is a compile-time constant and must never be freed. */
@@ -28,6 +28,15 @@
 	return len;
 }
 
+#ifdef CONFIG_OBJZ_LOG_DEFERRED
+- (int)encode:(uint8_t *)buf maxLength:(int)maxLen
+{
+	int len = (_length < (unsigned int)maxLen) ? (int)_length : maxLen;
+	memcpy(buf, _data, len);
+	return len;
+}
+#endif
+
 - (BOOL)isEqual:(id)anObject
 {
 	if (self == anObject) {
@@ -37,9 +46,28 @@
 	if (_length != other->_length) {
 		return NO;
 	}
+	if (_hash != 0 && other->_hash != 0 && _hash != other->_hash) {
+		return NO;
+	}
 	return memcmp(_data, other->_data, _length) == 0;
 }
 
+/*
+ * FNV-1a over the bytes, cached in _hash (0 means not yet computed).
+ * The transpiler precomputes the same value for string literals.
+ */
+- (unsigned int)hash
+{
+	if (_hash == 0) {
+		unsigned int h = 2166136261u;
+		for (unsigned int i = 0; i < _length; i++) {
+			h = (h ^ (unsigned char)_data[i]) * 16777619u;
+		}
+		_hash = h ? h : 1;
+	}
+	return _hash;
+}
+
 - (BOOL)isEqualToString:(OZString *)aString
 {
 	if (self == (id)aString) {
@@ -51,6 +79,9 @@
 	if (_length != aString->_length) {
 		return NO;
 	}
+	if (_hash != 0 && aString->_hash != 0 && _hash != aString->_hash) {
+		return NO;
+	}
 	return memcmp(_data, aString->_data, _length) == 0;
 }
 
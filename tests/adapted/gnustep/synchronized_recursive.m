@@ -3,7 +3,7 @@
  * License: MIT
  * Adaptation: Verifies recursive @synchronized on same object doesn't deadlock.
  */
-/* oz-pool: RecursiveSyncTest=1,OZSpinLock=2 */
+/* oz-pool: RecursiveSyncTest=1 */
 #import "OZTestBase.h"
 
 @interface RecursiveSyncTest : OZObject {
@@ -1,9 +1,9 @@
 /*
  * Adapted from: clang/test/Rewriter/objc-synchronized-1.m
  * License: Apache 2.0 with LLVM Exception
- * Adaptation: Verifies @synchronized lowers to OZSpinLock RAII correctly.
+ * Adaptation: Verifies @synchronized lowers to a scoped lock guard correctly.
  */
-/* oz-pool: SyncObj=1,OZSpinLock=1 */
+/* oz-pool: SyncObj=1 */
 #import "OZTestBase.h"
 
 @interface SyncObj : OZObject {
@@ -0,0 +1,44 @@
+/* oz-pool: OZObject=1,OZQ31=5,OZString=2,OZArray=1,OZDictionary=1,SameIterTest=1 */
+#import "OZFoundationBase.h"
+
+@interface SameIterTest : OZObject {
+	int _pairs;
+	int _keys;
+}
+- (void)iterateSameArrayTwice;
+- (void)iterateDictionary;
+- (int)pairs;
+- (int)keys;
+@end
+
+@implementation SameIterTest
+- (void)iterateSameArrayTwice {
+	OZArray *arr = @[@(1), @(2), @(3)];
+	id coll = arr;
+	_pairs = 0;
+	for (OZQ31 *a in arr) {
+		for (OZQ31 *b in arr) {
+			_pairs = _pairs + [a intValue] * [b intValue];
+		}
+	}
+	/* id-typed collection goes through the stack cursor protocol */
+	for (OZQ31 *a in coll) {
+		for (OZQ31 *b in coll) {
+			_pairs = _pairs + [a intValue] * [b intValue];
+		}
+	}
+}
+- (void)iterateDictionary {
+	OZDictionary *dict = @{@"a": @(1), @"b": @(2)};
+	_keys = 0;
+	for (id key in dict) {
+		_keys = _keys + 1;
+	}
+}
+- (int)pairs {
+	return _pairs;
+}
+- (int)keys {
+	return _keys;
+}
+@end
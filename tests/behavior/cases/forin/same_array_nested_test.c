@@ -0,0 +1,23 @@
+/* Behavior test: nested for-in over the same collection keeps separate cursors */
+#include "unity.h"
+#include "oz_dispatch.h"
+#include "SameIterTest_ozh.h"
+
+void test_same_array_nested_forin(void)
+{
+	struct SameIterTest *t = SameIterTest_alloc();
+	OZ_PROTOCOL_SEND_init((struct OZObject *)t);
+	SameIterTest_iterateSameArrayTwice(t);
+	/* (1+2+3) * (1+2+3) = 36, once typed and once through id */
+	TEST_ASSERT_EQUAL_INT(72, SameIterTest_pairs(t));
+	OZObject_release((struct OZObject *)t);
+}
+
+void test_dictionary_forin_visits_keys(void)
+{
+	struct SameIterTest *t = SameIterTest_alloc();
+	OZ_PROTOCOL_SEND_init((struct OZObject *)t);
+	SameIterTest_iterateDictionary(t);
+	TEST_ASSERT_EQUAL_INT(2, SameIterTest_keys(t));
+	OZObject_release((struct OZObject *)t);
+}
@@ -0,0 +1,31 @@
+/* oz-pool: OZObject=1,LogProbe=1,OZQ31=4 */
+/* oz-log-deferred */
+/* Behavior test: deferred OZLog records (message id + raw arguments). */
+#import "OZFoundationBase.h"
+#import <Foundation/OZLog.h>
+
+@interface LogProbe : OZObject
+- (void)logValue:(int)v name:(const char *)name;
+- (void)logObjects;
+- (void)logPlain;
+@end
+
+@implementation LogProbe
+
+- (void)logValue:(int)v name:(const char *)name
+{
+	OZLog("v=%d name=%s", v, name);
+}
+
+- (void)logObjects
+{
+	OZQ31 *q = @(10);
+	OZLog("%@ %@ %@", @"hi", q, nil);
+}
+
+- (void)logPlain
+{
+	OZLog("plain");
+}
+
+@end
@@ -0,0 +1,118 @@
+/*
+ * Behavior test: deferred OZLog backend.
+ * Each OZLog call site commits <id u16><len u16><payload> to the ring;
+ * oz_log_drain() hands the records back in order.
+ */
+#include "unity.h"
+#include "oz_dispatch.h"
+#include "LogProbe_ozh.h"
+
+static uint8_t out[CONFIG_OBJZ_LOG_DEFERRED_SIZE];
+
+static struct LogProbe *probe(void)
+{
+	struct LogProbe *p = LogProbe_alloc();
+
+	OZ_PROTOCOL_SEND_init((struct OZObject *)p);
+	oz_log_drain(out, sizeof(out));
+	return p;
+}
+
+static uint16_t rec_id(const uint8_t *rec)
+{
+	return (uint16_t)(rec[0] | rec[1] << 8);
+}
+
+static uint16_t rec_len(const uint8_t *rec)
+{
+	return (uint16_t)(rec[2] | rec[3] << 8);
+}
+
+void test_int_and_string_args(void)
+{
+	struct LogProbe *p = probe();
+	static const uint8_t payload[] = {0xfe, 0xff, 0xff, 0xff, 3, 'a', 'b', 'c'};
+
+	LogProbe_logValue_name_(p, -2, "abc");
+	TEST_ASSERT_EQUAL_INT(4 + sizeof(payload), oz_log_drain(out, sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(sizeof(payload), rec_len(out));
+	TEST_ASSERT_EQUAL_MEMORY(payload, out + 4, sizeof(payload));
+	OZObject_release((struct OZObject *)p);
+}
+
+void test_null_string_arg(void)
+{
+	struct LogProbe *p = probe();
+
+	LogProbe_logValue_name_(p, 1, NULL);
+	TEST_ASSERT_EQUAL_INT(12, oz_log_drain(out, sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(5, rec_len(out));
+	TEST_ASSERT_EQUAL_HEX8(0xff, out[8]);
+	OZObject_release((struct OZObject *)p);
+}
+
+void test_same_site_same_id(void)
+{
+	struct LogProbe *p = probe();
+
+	LogProbe_logValue_name_(p, 1, "a");
+	LogProbe_logPlain(p);
+	LogProbe_logValue_name_(p, 2, "b");
+	TEST_ASSERT_EQUAL_INT(12 + 4 + 12, oz_log_drain(out, sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(rec_id(out), rec_id(out + 16));
+	TEST_ASSERT_NOT_EQUAL(rec_id(out), rec_id(out + 12));
+	TEST_ASSERT_EQUAL_INT(0, rec_len(out + 12));
+	OZObject_release((struct OZObject *)p);
+}
+
+void test_object_args(void)
+{
+	struct LogProbe *p = probe();
+	uint8_t *rec = out + 4;
+
+	LogProbe_logObjects(p);
+	TEST_ASSERT_EQUAL_INT(4 + 16, oz_log_drain(out, sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(16, rec_len(out));
+	/* @"hi": class id, length 2, bytes */
+	TEST_ASSERT_EQUAL_INT(OZ_CLASS_OZString, rec[0] | rec[1] << 8);
+	TEST_ASSERT_EQUAL_INT(2, rec[2]);
+	TEST_ASSERT_EQUAL_MEMORY("hi", rec + 3, 2);
+	/* @(10): raw 10 << 27, shift 4 */
+	rec += 5;
+	TEST_ASSERT_EQUAL_INT(OZ_CLASS_OZQ31, rec[0] | rec[1] << 8);
+	TEST_ASSERT_EQUAL_INT(5, rec[2]);
+	TEST_ASSERT_EQUAL_HEX32(10u << 27, (uint32_t)(rec[3] | rec[4] << 8 |
+						 rec[5] << 16 | (uint32_t)rec[6] << 24));
+	TEST_ASSERT_EQUAL_INT(4, rec[7]);
+	/* nil */
+	rec += 8;
+	TEST_ASSERT_EQUAL_HEX16(0xffff, rec[0] | rec[1] << 8);
+	TEST_ASSERT_EQUAL_INT(0, rec[2]);
+	OZObject_release((struct OZObject *)p);
+}
+
+void test_full_ring_drops(void)
+{
+	struct LogProbe *p = probe();
+	long dropped = oz_atomic_get(&oz_log_dropped);
+	int n;
+
+	for (int i = 0; i < CONFIG_OBJZ_LOG_DEFERRED_SIZE / 4; i++) {
+		LogProbe_logPlain(p);
+	}
+	TEST_ASSERT_EQUAL_INT(CONFIG_OBJZ_LOG_DEFERRED_SIZE,
+			      oz_log_drain(out, sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(0, oz_log_drain(out, sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(dropped, oz_atomic_get(&oz_log_dropped));
+
+	LogProbe_logPlain(p);
+	n = oz_log_drain(out, sizeof(out));
+	TEST_ASSERT_EQUAL_INT(4, n);
+
+	for (int i = 0; i <= CONFIG_OBJZ_LOG_DEFERRED_SIZE / 4; i++) {
+		LogProbe_logPlain(p);
+	}
+	TEST_ASSERT_EQUAL_INT(dropped + 1, oz_atomic_get(&oz_log_dropped));
+	oz_log_drain(out, sizeof(out));
+	OZObject_release((struct OZObject *)p);
+}
@@ -0,0 +1,36 @@
+/* oz-pool: OZObject=1,LogQ31=1,OZQ31=4 */
+/* oz-log */
+/* Behavior test: OZLog %.N@ reaches DescribingProtocol (OZQ31). */
+#import "OZFoundationBase.h"
+#import <Foundation/OZLog.h>
+
+@interface LogQ31 : OZObject
+- (void)logThird;
+- (void)logThirdPrecision:(int)v;
+- (void)logNilPrecision;
+@end
+
+@implementation LogQ31
+
+- (void)logThird
+{
+	OZQ31 *a = @(1);
+	OZQ31 *b = @(3);
+	OZQ31 *c = [a div:b];
+	OZLog("q=%@", c);
+}
+
+- (void)logThirdPrecision:(int)v
+{
+	OZQ31 *a = @(1);
+	OZQ31 *b = @(3);
+	OZQ31 *c = [a div:b];
+	OZLog("v=%d q=%.2@ end", v, c);
+}
+
+- (void)logNilPrecision
+{
+	OZLog("q=%.2@", nil);
+}
+
+@end
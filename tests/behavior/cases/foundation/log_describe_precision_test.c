@@ -0,0 +1,57 @@
+/*
+ * Behavior test: OZLog() object formatting through src/OZLog.c.
+ * %.N@ must hand N to cDescription:maxLength:precision:; plain %@ keeps
+ * cDescription:maxLength: and its default 14 digits.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include "unity.h"
+#include "oz_dispatch.h"
+#include "LogQ31_ozh.h"
+
+static char logged[256];
+
+void printk(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vsnprintf(logged, sizeof(logged), fmt, args);
+	va_end(args);
+}
+
+static struct LogQ31 *probe(void)
+{
+	struct LogQ31 *p = LogQ31_alloc();
+
+	OZ_PROTOCOL_SEND_init((struct OZObject *)p);
+	logged[0] = '\0';
+	return p;
+}
+
+void test_default_precision(void)
+{
+	struct LogQ31 *p = probe();
+
+	LogQ31_logThird(p);
+	TEST_ASSERT_EQUAL_STRING("q=0.33333333348855\n", logged);
+	OZObject_release((struct OZObject *)p);
+}
+
+void test_precision_reaches_describing_protocol(void)
+{
+	struct LogQ31 *p = probe();
+
+	LogQ31_logThirdPrecision_(p, 7);
+	TEST_ASSERT_EQUAL_STRING("v=7 q=0.33 end\n", logged);
+	OZObject_release((struct OZObject *)p);
+}
+
+void test_precision_on_nil(void)
+{
+	struct LogQ31 *p = probe();
+
+	LogQ31_logNilPrecision(p);
+	TEST_ASSERT_EQUAL_STRING("q=(nil)\n", logged);
+	OZObject_release((struct OZObject *)p);
+}
@@ -13,9 +13,15 @@
 - (void)buildAndAppendGrow;
 - (void)buildAndSetString;
 - (void)buildAndSetStringNil;
+- (void)buildAndAppendSelf;
+- (void)buildAndAppendSelfGrow;
+- (void)buildWithLargeCapacity;
+- (BOOL)buildAndAppendPastLargestClass;
+- (void)clear;
 /* query methods — read from _ms ivar */
 - (const char *)result;
 - (unsigned int)resultLength;
+- (unsigned int)resultCapacity;
 /* OZString method tests (no ivar needed) */
 - (BOOL)hasPrefixTrue;
 - (BOOL)hasSuffixTrue;
@@ -74,6 +80,40 @@
 	[_ms setString:nil];
 }
 
+- (void)buildAndAppendSelf
+{
+	_ms = [[OZMutableString alloc] initWithCString:"abc"];
+	[_ms appendString:_ms];
+}
+
+- (void)buildAndAppendSelfGrow
+{
+	_ms = [[OZMutableString alloc] initWithCString:"0123456789abcdefghi"];
+	[_ms appendString:_ms];
+}
+
+- (void)buildWithLargeCapacity
+{
+	_ms = [[OZMutableString alloc] initWithCapacity:100];
+}
+
+- (BOOL)buildAndAppendPastLargestClass
+{
+	/* 300 characters need more than the 256-byte largest size class */
+	char big[301];
+	for (int i = 0; i < 300; i++) {
+		big[i] = 'x';
+	}
+	big[300] = '\0';
+	_ms = [[OZMutableString alloc] initWithCString:"abc"];
+	return [_ms appendCString:big];
+}
+
+- (void)clear
+{
+	_ms = nil;
+}
+
 - (const char *)result
 {
 	return [_ms cString];
@@ -84,6 +124,11 @@
 	return [_ms length];
 }
 
+- (unsigned int)resultCapacity
+{
+	return [_ms capacity];
+}
+
 - (BOOL)hasPrefixTrue
 {
 	OZString *s = @"hello world";
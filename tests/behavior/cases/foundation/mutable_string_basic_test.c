@@ -3,6 +3,10 @@
 #include "oz_dispatch.h"
 #include "MutableStringTest_ozh.h"
 
+/* String buffer size classes generated in oz_dispatch.c */
+extern oz_slab_t oz_mstring_slab_64;
+extern oz_slab_t oz_mstring_slab_128;
+
 static struct MutableStringTest *t;
 
 void setUp(void)
@@ -65,6 +69,52 @@ void test_set_string_nil(void)
 	TEST_ASSERT_EQUAL_STRING("", MutableStringTest_result(t));
 }
 
+void test_short_string_stays_inline(void)
+{
+	MutableStringTest_buildFromCString(t);
+	TEST_ASSERT_EQUAL_UINT(24, MutableStringTest_resultCapacity(t));
+}
+
+void test_growth_takes_size_class_buffer(void)
+{
+	MutableStringTest_buildAndAppendGrow(t);
+	/* 26 chars outgrow the 24-byte inline buffer: 48 rounds up to 64 */
+	TEST_ASSERT_EQUAL_UINT(64, MutableStringTest_resultCapacity(t));
+	TEST_ASSERT_EQUAL_UINT32(1, oz_slab_num_used(&oz_mstring_slab_64));
+	MutableStringTest_clear(t);
+	TEST_ASSERT_EQUAL_UINT32(0, oz_slab_num_used(&oz_mstring_slab_64));
+}
+
+void test_init_with_large_capacity(void)
+{
+	MutableStringTest_buildWithLargeCapacity(t);
+	TEST_ASSERT_EQUAL_UINT(128, MutableStringTest_resultCapacity(t));
+	TEST_ASSERT_EQUAL_UINT32(1, oz_slab_num_used(&oz_mstring_slab_128));
+	TEST_ASSERT_EQUAL_STRING("", MutableStringTest_result(t));
+}
+
+void test_append_past_largest_class_fails(void)
+{
+	TEST_ASSERT_FALSE(MutableStringTest_buildAndAppendPastLargestClass(t));
+	TEST_ASSERT_EQUAL_STRING("abc", MutableStringTest_result(t));
+	TEST_ASSERT_EQUAL_UINT(3, MutableStringTest_resultLength(t));
+	TEST_ASSERT_EQUAL_UINT(24, MutableStringTest_resultCapacity(t));
+}
+
+void test_append_self(void)
+{
+	MutableStringTest_buildAndAppendSelf(t);
+	TEST_ASSERT_EQUAL_STRING("abcabc", MutableStringTest_result(t));
+}
+
+void test_append_self_while_growing(void)
+{
+	MutableStringTest_buildAndAppendSelfGrow(t);
+	TEST_ASSERT_EQUAL_STRING("0123456789abcdefghi0123456789abcdefghi",
+				 MutableStringTest_result(t));
+	TEST_ASSERT_EQUAL_UINT(38, MutableStringTest_resultLength(t));
+}
+
 void test_has_prefix(void)
 {
 	TEST_ASSERT_TRUE(MutableStringTest_hasPrefixTrue(t));
@@ -13,6 +13,8 @@
 - (float)divSmallByLarge;
 - (float)divLargeBySmall;
 - (int)divByZeroRaw;
+/* 1/3 through DescribingProtocol */
+- (int)describeThird:(char *)buf maxLength:(int)maxLen precision:(int)precision;
 @end
 
 @implementation Q31NoStdio
@@ -98,4 +100,13 @@
 	return v;
 }
 
+- (int)describeThird:(char *)buf maxLength:(int)maxLen precision:(int)precision
+{
+	OZQ31 *a = @(1);
+	OZQ31 *b = @(3);
+	OZQ31 *c = [a div:b];
+	int n = [c cDescription:buf maxLength:maxLen precision:precision];
+	return n;
+}
+
 @end
@@ -590,3 +590,27 @@ void test_str_precision_six_smallest_positive(void)
 	q31_str_prec(1, 0, buf, sizeof(buf), 6);
 	TEST_ASSERT_EQUAL_STRING("0", buf);
 }
+
+/* ── DescribingProtocol: precision ────────────────────────────── */
+
+void test_describe_precision(void)
+{
+	struct Q31NoStdio *t = Q31NoStdio_alloc();
+	OZ_PROTOCOL_SEND_init((struct OZObject *)t);
+	char buf[32];
+	int n = Q31NoStdio_describeThird_maxLength_precision_(t, buf, sizeof(buf), 2);
+	buf[n] = '\0';
+	TEST_ASSERT_EQUAL_STRING("0.33", buf);
+	OZObject_release((struct OZObject *)t);
+}
+
+void test_describe_default_precision(void)
+{
+	struct Q31NoStdio *t = Q31NoStdio_alloc();
+	OZ_PROTOCOL_SEND_init((struct OZObject *)t);
+	char buf[32];
+	int n = Q31NoStdio_describeThird_maxLength_precision_(t, buf, sizeof(buf), -1);
+	buf[n] = '\0';
+	TEST_ASSERT_EQUAL_STRING("0.33333333348855", buf);
+	OZObject_release((struct OZObject *)t);
+}
@@ -0,0 +1,17 @@
+/* oz-pool: Node=200 */
+/* oz-deferred-dealloc */
+#import "OZTestBase.h"
+
+@interface Node : OZObject {
+	Node *_next;
+}
+- (instancetype)initWithNext:(Node *)next;
+@end
+
+@implementation Node
+- (instancetype)initWithNext:(Node *)next
+{
+	_next = next;
+	return self;
+}
+@end
@@ -0,0 +1,55 @@
+/* Behavior test: --deferred-dealloc frees a long chain without recursion */
+#include "unity.h"
+#include "Node_ozh.h"
+
+#define CHAIN_LEN 200
+
+/* Each node's ivar holds the only reference to the one after it */
+static struct Node *build_chain(void)
+{
+	struct Node *head = NULL;
+
+	for (int i = 0; i < CHAIN_LEN; i++) {
+		struct Node *n = Node_alloc();
+		TEST_ASSERT_NOT_NULL(n);
+		Node_initWithNext_(n, head);
+		if (head) {
+			OZObject_release((struct OZObject *)head);
+		}
+		head = n;
+	}
+	return head;
+}
+
+void test_release_finalises_one_batch(void)
+{
+	struct Node *head = build_chain();
+	TEST_ASSERT_EQUAL_UINT32(CHAIN_LEN, oz_slab_num_used(&oz_slab_Node));
+
+	OZObject_release((struct OZObject *)head);
+	TEST_ASSERT_EQUAL_UINT32(CHAIN_LEN - OZ_DEALLOC_DRAIN_BATCH,
+				 oz_slab_num_used(&oz_slab_Node));
+
+	for (int i = 0; i < CHAIN_LEN; i++) {
+		oz_dealloc_drain();
+	}
+}
+
+void test_drain_returns_every_block(void)
+{
+	struct Node *head = build_chain();
+
+	OZObject_release((struct OZObject *)head);
+	for (int i = 0; i < CHAIN_LEN / OZ_DEALLOC_DRAIN_BATCH + 1; i++) {
+		oz_dealloc_drain();
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, oz_slab_num_used(&oz_slab_Node));
+
+	/* The whole pool is allocatable again */
+	head = build_chain();
+	OZObject_release((struct OZObject *)head);
+	for (int i = 0; i < CHAIN_LEN / OZ_DEALLOC_DRAIN_BATCH + 1; i++) {
+		oz_dealloc_drain();
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, oz_slab_num_used(&oz_slab_Node));
+}
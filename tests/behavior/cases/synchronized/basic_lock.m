@@ -1,4 +1,4 @@
-/* oz-pool: LockTest=1,OZSpinLock=1 */
+/* oz-pool: LockTest=1 */
 #import "OZTestBase.h"
 
 @interface LockTest : OZObject {
@@ -1,4 +1,4 @@
-/* oz-pool: SyncCounter=1,OZSpinLock=1 */
+/* oz-pool: SyncCounter=1 */
 #import "OZTestBase.h"
 
 @interface SyncCounter : OZObject {
@@ -1,4 +1,4 @@
-/* oz-pool: EarlyRet=1,OZSpinLock=1 */
+/* oz-pool: EarlyRet=1 */
 #import "OZTestBase.h"
 
 @interface EarlyRet : OZObject {
@@ -1,4 +1,4 @@
-/* oz-pool: NestLock=2,OZSpinLock=2 */
+/* oz-pool: NestLock=2 */
 #import "OZTestBase.h"
 
 @interface NestLock : OZObject {
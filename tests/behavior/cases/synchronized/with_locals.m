@@ -1,4 +1,4 @@
-/* oz-pool: SyncLocal=2,OZSpinLock=1 */
+/* oz-pool: SyncLocal=2 */
 #import "OZTestBase.h"
 
 @interface SyncLocal : OZObject {
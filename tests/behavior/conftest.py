@@ -34,6 +34,8 @@ def compile_and_run(request):
     cflags = request.config.getoption("--cflags")
     ldflags = request.config.getoption("--ldflags")
     check_leaks = request.config.getoption("--check-leaks")
+    dispatch_profile = request.config.getoption("--dispatch-profile")
+    pool_profile = request.config.getoption("--pool-profile")
 
     def _run(m_path: pathlib.Path) -> subprocess.CompletedProcess:
         cmd = [sys.executable, str(COMPILE_AND_RUN), str(m_path),
@@ -46,6 +48,10 @@ def compile_and_run(request):
             cmd.append(f"--ldflags={ldflags}")
         if check_leaks:
             cmd.append("--check-leaks")
+        if dispatch_profile:
+            cmd.append(f"--dispatch-profile={dispatch_profile}")
+        if pool_profile:
+            cmd.append(f"--pool-profile={pool_profile}")
         result = subprocess.run(
             cmd,
             capture_output=True, text=True,
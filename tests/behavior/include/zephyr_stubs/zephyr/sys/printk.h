@@ -0,0 +1,13 @@
+/* Minimal Zephyr printk stub for behavior tests (host-side). */
+#ifndef ZEPHYR_SYS_PRINTK_STUB_H
+#define ZEPHYR_SYS_PRINTK_STUB_H
+
+#include <stdio.h>
+
+/* Defined by the test, so it can check what OZLog() printed */
+void printk(const char *fmt, ...);
+
+#define snprintk  snprintf
+#define vsnprintk vsnprintf
+
+#endif /* ZEPHYR_SYS_PRINTK_STUB_H */
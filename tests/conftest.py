@@ -16,3 +16,7 @@ def pytest_addoption(parser):
                      help="Extra linker flags")
     parser.addoption("--check-leaks", action="store_true", default=False,
                      help="Enable leak detection via LSan")
+    parser.addoption("--dispatch-profile", default=None,
+                     help="Append protocol dispatch hit counts to this file")
+    parser.addoption("--pool-profile", default=None,
+                     help="Append per-class slab high-water marks to this file")
@@ -56,7 +56,7 @@ def compile_and_run_c(request):
             test_bin = tmpdir / "test_bin"
             cc_flags = [compiler, "-std=c11", f"-{opt}",
                         "-Wall", "-Werror", "-Wno-unused-function",
-                        "-DOZ_PLATFORM_HOST",
+                        "-DOZ_PLATFORM_HOST", "-pthread",
                         "-I", str(PAL_INC),
                         "-I", str(UNITY_DIR),
                         str(c_path), str(test_main),
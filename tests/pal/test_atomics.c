@@ -61,3 +61,86 @@ void test_atomic_inc_dec_roundtrip(void)
 	oz_atomic_dec_and_test(&val);
 	TEST_ASSERT_EQUAL_INT(1, oz_atomic_get(&val));
 }
+
+void test_atomic_set_and_cas(void)
+{
+	oz_atomic_t val;
+	oz_atomic_init(&val, 0);
+
+	oz_atomic_set(&val, 7);
+	TEST_ASSERT_EQUAL_INT(7, oz_atomic_get(&val));
+	TEST_ASSERT_FALSE(oz_atomic_cas(&val, 6, 9));
+	TEST_ASSERT_EQUAL_INT(7, oz_atomic_get(&val));
+	TEST_ASSERT_TRUE(oz_atomic_cas(&val, 7, 9));
+	TEST_ASSERT_EQUAL_INT(9, oz_atomic_get(&val));
+}
+
+void test_nonatomic_inc_dec_and_test(void)
+{
+	oz_atomic_t val;
+	oz_atomic_init(&val, 1);
+
+	TEST_ASSERT_EQUAL_INT(2, oz_nonatomic_inc(&val));
+	TEST_ASSERT_FALSE(oz_nonatomic_dec_and_test(&val));
+	TEST_ASSERT_TRUE(oz_nonatomic_dec_and_test(&val));
+	TEST_ASSERT_EQUAL_INT(0, oz_atomic_get(&val));
+}
+
+void test_thread_is_self(void)
+{
+	oz_thread_id_t me = oz_thread_self();
+	TEST_ASSERT_TRUE(oz_thread_is_self(me));
+}
+
+void test_atomic_field_load_store(void)
+{
+	float f = 0.0f;
+	float in = 2.5f;
+	float out = 0.0f;
+	uint16_t h = 0;
+	uint16_t hin = 0xBEEF;
+	uint16_t hout = 0;
+
+	oz_atomic_store_field(&f, &in);
+	oz_atomic_load_field(&f, &out);
+	TEST_ASSERT_EQUAL_FLOAT(2.5f, out);
+
+	oz_atomic_store_field(&h, &hin);
+	oz_atomic_load_field(&h, &hout);
+	TEST_ASSERT_EQUAL_HEX16(0xBEEF, hout);
+}
+
+void test_atomic_ptr_swap_returns_old(void)
+{
+	int a = 1;
+	int b = 2;
+	void *slot = &a;
+
+	TEST_ASSERT_EQUAL_PTR(&a, oz_atomic_ptr_swap(&slot, &b));
+	TEST_ASSERT_EQUAL_PTR(&b, slot);
+	TEST_ASSERT_EQUAL_PTR(&b, oz_atomic_ptr_swap(&slot, NULL));
+	TEST_ASSERT_NULL(slot);
+}
+
+void test_atomic_ptr_cas(void)
+{
+	int a = 1;
+	int b = 2;
+	void *slot = &a;
+
+	TEST_ASSERT_FALSE(oz_atomic_ptr_cas(&slot, &b, NULL));
+	TEST_ASSERT_EQUAL_PTR(&a, slot);
+	TEST_ASSERT_TRUE(oz_atomic_ptr_cas(&slot, &a, &b));
+	TEST_ASSERT_EQUAL_PTR(&b, slot);
+}
+
+void test_atomic_link_roundtrip(void)
+{
+	oz_atomic_t rc;
+	int node = 0;
+
+	oz_atomic_set_link(&rc, &node);
+	TEST_ASSERT_EQUAL_PTR(&node, oz_atomic_get_link(&rc));
+	oz_atomic_set_link(&rc, NULL);
+	TEST_ASSERT_NULL(oz_atomic_get_link(&rc));
+}
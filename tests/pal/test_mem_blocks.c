@@ -40,3 +40,43 @@ void test_mem_blocks_free_at_zero_safe(void)
 	/* num_used is 0; free should not underflow */
 	TEST_ASSERT_EQUAL_UINT32(0, pool.num_used);
 }
+
+void test_mem_blocks_runs_are_adjacent(void)
+{
+	OZ_MEM_BLOCKS_DEFINE(pool, sizeof(void *), 8, 4);
+	void *a = NULL;
+	void *b = NULL;
+
+	oz_mem_blocks_alloc_contiguous(&pool, 3, &a);
+	oz_mem_blocks_alloc_contiguous(&pool, 2, &b);
+	TEST_ASSERT_EQUAL_PTR(pool.buffer, a);
+	TEST_ASSERT_EQUAL_PTR((char *)a + 3 * sizeof(void *), b);
+	oz_mem_blocks_free_contiguous(&pool, b, 2);
+	oz_mem_blocks_free_contiguous(&pool, a, 3);
+}
+
+void test_mem_blocks_fragmentation_returns_enomem(void)
+{
+	OZ_MEM_BLOCKS_DEFINE(pool, sizeof(void *), 4, 4);
+	void *blk[4] = {NULL, NULL, NULL, NULL};
+	void *pair = NULL;
+
+	for (int i = 0; i < 4; i++) {
+		oz_mem_blocks_alloc_contiguous(&pool, 1, &blk[i]);
+	}
+	oz_mem_blocks_free_contiguous(&pool, blk[0], 1);
+	oz_mem_blocks_free_contiguous(&pool, blk[2], 1);
+
+	/* Two blocks are free, but not next to each other */
+	TEST_ASSERT_EQUAL_UINT32(2, pool.num_used);
+	TEST_ASSERT_EQUAL_INT(OZ_ENOMEM,
+			      oz_mem_blocks_alloc_contiguous(&pool, 2, &pair));
+	TEST_ASSERT_NULL(pair);
+
+	oz_mem_blocks_free_contiguous(&pool, blk[1], 1);
+	TEST_ASSERT_EQUAL_INT(OZ_OK,
+			      oz_mem_blocks_alloc_contiguous(&pool, 2, &pair));
+	TEST_ASSERT_EQUAL_PTR(blk[0], pair);
+	oz_mem_blocks_free_contiguous(&pool, pair, 2);
+	oz_mem_blocks_free_contiguous(&pool, blk[3], 1);
+}
@@ -77,3 +77,76 @@ void test_slab_free_at_zero_safe(void)
 	/* num_used is 0; free should not underflow */
 	TEST_ASSERT_EQUAL_UINT32(0, zero_slab.num_used);
 }
+
+void test_slab_blocks_are_aligned_and_distinct(void)
+{
+	OZ_SLAB_DEFINE(align_slab, 12, 3, 4);
+	void *blk[3] = {NULL, NULL, NULL};
+
+	for (int i = 0; i < 3; i++) {
+		TEST_ASSERT_EQUAL_INT(OZ_OK, oz_slab_alloc(&align_slab, &blk[i]));
+		TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)blk[i] % sizeof(void *));
+	}
+	/* 12-byte blocks are rounded up to a pointer-size multiple */
+	TEST_ASSERT_EQUAL_UINT(align_slab.block_size,
+			       (uintptr_t)blk[1] - (uintptr_t)blk[0]);
+	TEST_ASSERT_EQUAL_UINT(align_slab.block_size,
+			       (uintptr_t)blk[2] - (uintptr_t)blk[1]);
+	for (int i = 2; i >= 0; i--) {
+		oz_slab_free(&align_slab, blk[i]);
+	}
+}
+
+void test_slab_blocks_come_from_static_buffer(void)
+{
+	OZ_SLAB_DEFINE(buf_slab, 24, 2, 4);
+	void *a = NULL;
+	void *b = NULL;
+	uintptr_t lo = (uintptr_t)buf_slab.buffer;
+	uintptr_t hi = lo + buf_slab.block_size * buf_slab.num_blocks;
+
+	oz_slab_alloc(&buf_slab, &a);
+	oz_slab_alloc(&buf_slab, &b);
+	TEST_ASSERT_TRUE((uintptr_t)a >= lo && (uintptr_t)a < hi);
+	TEST_ASSERT_TRUE((uintptr_t)b >= lo && (uintptr_t)b < hi);
+	oz_slab_free(&buf_slab, b);
+	oz_slab_free(&buf_slab, a);
+}
+
+void test_slab_free_block_is_reused_first(void)
+{
+	OZ_SLAB_DEFINE(lifo_slab, 16, 4, 4);
+	void *a = NULL;
+	void *b = NULL;
+	void *c = NULL;
+
+	oz_slab_alloc(&lifo_slab, &a);
+	oz_slab_alloc(&lifo_slab, &b);
+	oz_slab_free(&lifo_slab, a);
+	oz_slab_alloc(&lifo_slab, &c);
+	TEST_ASSERT_EQUAL_PTR(a, c);
+	oz_slab_free(&lifo_slab, c);
+	oz_slab_free(&lifo_slab, b);
+}
+
+void test_slab_max_used_is_high_water_mark(void)
+{
+	OZ_SLAB_DEFINE(peak_slab, 16, 4, 4);
+	void *blk[3] = {NULL, NULL, NULL};
+
+	TEST_ASSERT_EQUAL_UINT32(4, oz_slab_num_blocks(&peak_slab));
+	TEST_ASSERT_EQUAL_UINT32(0, oz_slab_max_used(&peak_slab));
+	for (int i = 0; i < 3; i++) {
+		oz_slab_alloc(&peak_slab, &blk[i]);
+	}
+	oz_slab_free(&peak_slab, blk[2]);
+	oz_slab_free(&peak_slab, blk[1]);
+	TEST_ASSERT_EQUAL_UINT32(1, oz_slab_num_used(&peak_slab));
+	TEST_ASSERT_EQUAL_UINT32(3, oz_slab_max_used(&peak_slab));
+
+	/* Falling back below the peak and rising again keeps the mark */
+	oz_slab_alloc(&peak_slab, &blk[1]);
+	TEST_ASSERT_EQUAL_UINT32(3, oz_slab_max_used(&peak_slab));
+	oz_slab_free(&peak_slab, blk[1]);
+	oz_slab_free(&peak_slab, blk[0]);
+}
@@ -0,0 +1,265 @@
+/* PAL multithreaded stress tests (host backend with OZ_PLATFORM_HOST_MT) */
+#define OZ_PLATFORM_HOST_MT
+#include <pthread.h>
+#include "unity.h"
+#include "platform/oz_platform.h"
+#include "platform/oz_lock.h"
+
+#define N_THREADS 8
+#define N_ITERS 20000
+
+/*
+ * Hand-written equivalents of what the transpiler emits for a root class
+ * with a strong atomic property and a wide (spinlock-backed) one.
+ */
+struct point {
+	long x;
+	long y;
+};
+
+struct obj {
+	oz_atomic_t rc;
+	struct obj *_child;
+	struct point _pos;
+	oz_spinlock_t _oz_prop_lock;
+};
+
+OZ_SLAB_DEFINE(obj_slab, sizeof(struct obj), N_THREADS * 4 + 2, 4);
+
+struct oz_sync_stripe oz_sync_stripes[OZ_SYNC_LOCK_STRIPES];
+
+static struct obj *obj_alloc(void)
+{
+	struct obj *o = NULL;
+
+	if (oz_slab_alloc(&obj_slab, (void **)&o) != OZ_OK) {
+		return NULL;
+	}
+	memset(o, 0, sizeof(*o));
+	oz_atomic_init(&o->rc, 1);
+	return o;
+}
+
+static void obj_retain(struct obj *o)
+{
+	if (o) {
+		oz_atomic_inc(&o->rc);
+	}
+}
+
+static void obj_release(struct obj *o)
+{
+	if (o && oz_atomic_dec_and_test(&o->rc)) {
+		obj_release(o->_child);
+		oz_slab_free(&obj_slab, o);
+	}
+}
+
+static struct obj *obj_child(struct obj *self)
+{
+	struct obj *val;
+	oz_atomic_load_field(&self->_child, &val);
+	return val;
+}
+
+static void obj_setChild(struct obj *self, struct obj *child)
+{
+	obj_retain(child);
+	struct obj *old = (struct obj *)oz_atomic_ptr_swap(
+		(void **)&self->_child, (void *)child);
+	obj_release(old);
+}
+
+static struct point obj_pos(struct obj *self)
+{
+	struct point val = {0};
+	OZ_SPINLOCK(&self->_oz_prop_lock) {
+		val = self->_pos;
+	}
+	return val;
+}
+
+static void obj_setPos(struct obj *self, struct point pos)
+{
+	OZ_SPINLOCK(&self->_oz_prop_lock) {
+		self->_pos = pos;
+	}
+}
+
+static bool obj_in_slab(const struct obj *o)
+{
+	uintptr_t lo = (uintptr_t)obj_slab.buffer;
+	uintptr_t hi = lo + obj_slab.block_size * obj_slab.num_blocks;
+
+	return (uintptr_t)o >= lo && (uintptr_t)o < hi;
+}
+
+static void run_threads(void *(*fn)(void *), void *arg)
+{
+	pthread_t tids[N_THREADS];
+
+	for (int i = 0; i < N_THREADS; i++) {
+		TEST_ASSERT_EQUAL_INT(0, pthread_create(&tids[i], NULL, fn, arg));
+	}
+	for (int i = 0; i < N_THREADS; i++) {
+		pthread_join(tids[i], NULL);
+	}
+}
+
+static void *retain_release_worker(void *arg)
+{
+	struct obj *shared = arg;
+
+	for (int i = 0; i < N_ITERS; i++) {
+		obj_retain(shared);
+		obj_retain(shared);
+		obj_release(shared);
+		obj_release(shared);
+	}
+	return NULL;
+}
+
+void test_threads_retain_release_balance(void)
+{
+	struct obj *shared = obj_alloc();
+
+	TEST_ASSERT_NOT_NULL(shared);
+	run_threads(retain_release_worker, shared);
+	TEST_ASSERT_EQUAL_INT(1, oz_atomic_get(&shared->rc));
+	obj_release(shared);
+	TEST_ASSERT_EQUAL_UINT32(0, oz_slab_outstanding_count(&obj_slab));
+}
+
+static atomic_int bad_reads;
+
+static void *strong_property_worker(void *arg)
+{
+	struct obj *holder = arg;
+
+	for (int i = 0; i < N_ITERS / 8; i++) {
+		struct obj *fresh = obj_alloc();
+
+		if (!fresh) {
+			atomic_fetch_add(&bad_reads, 1);
+			continue;
+		}
+		obj_setChild(holder, fresh);
+		obj_release(fresh);
+
+		struct obj *seen = obj_child(holder);
+
+		if (!seen || !obj_in_slab(seen)) {
+			atomic_fetch_add(&bad_reads, 1);
+		}
+	}
+	return NULL;
+}
+
+void test_threads_strong_atomic_property(void)
+{
+	struct obj *holder = obj_alloc();
+
+	atomic_store(&bad_reads, 0);
+	run_threads(strong_property_worker, holder);
+	TEST_ASSERT_EQUAL_INT(0, atomic_load(&bad_reads));
+
+	/* Only the holder and its last child are still alive */
+	TEST_ASSERT_EQUAL_UINT32(2, oz_slab_outstanding_count(&obj_slab));
+	TEST_ASSERT_EQUAL_INT(1, oz_atomic_get(&obj_child(holder)->rc));
+	obj_release(holder);
+	TEST_ASSERT_EQUAL_INT(0, oz_slab_check_leaks(&obj_slab, "obj_slab"));
+}
+
+static void *wide_property_worker(void *arg)
+{
+	struct obj *holder = arg;
+
+	for (long i = 0; i < N_ITERS; i++) {
+		obj_setPos(holder, (struct point){i, i});
+
+		struct point p = obj_pos(holder);
+
+		if (p.x != p.y) {
+			atomic_fetch_add(&bad_reads, 1);
+		}
+	}
+	return NULL;
+}
+
+void test_threads_wide_atomic_property_never_tears(void)
+{
+	struct obj *holder = obj_alloc();
+
+	atomic_store(&bad_reads, 0);
+	run_threads(wide_property_worker, holder);
+	TEST_ASSERT_EQUAL_INT(0, atomic_load(&bad_reads));
+	obj_release(holder);
+	TEST_ASSERT_EQUAL_UINT32(0, oz_slab_outstanding_count(&obj_slab));
+}
+
+static long sync_counter;
+
+static void *synchronized_worker(void *arg)
+{
+	for (int i = 0; i < N_ITERS; i++) {
+		struct oz_sync_stripe *outer = oz_sync_enter(arg);
+		struct oz_sync_stripe *inner = oz_sync_enter(arg);
+
+		sync_counter++;
+		oz_sync_exit(inner);
+		oz_sync_exit(outer);
+	}
+	return NULL;
+}
+
+void test_threads_synchronized_is_exclusive_and_recursive(void)
+{
+	struct obj *token = obj_alloc();
+
+	sync_counter = 0;
+	run_threads(synchronized_worker, token);
+	TEST_ASSERT_EQUAL_INT(N_THREADS * N_ITERS, sync_counter);
+	obj_release(token);
+}
+
+OZ_MEM_BLOCKS_DEFINE(item_pool, sizeof(void *), N_THREADS * 6, 4);
+
+static void *pool_worker(void *arg)
+{
+	uintptr_t tag = (uintptr_t)arg;
+
+	for (int i = 0; i < N_ITERS / 4; i++) {
+		void **run = NULL;
+		uint32_t count = 1 + (uint32_t)(i % 5);
+
+		if (oz_mem_blocks_alloc_contiguous(&item_pool, count,
+						   (void **)&run) != OZ_OK) {
+			continue;
+		}
+		for (uint32_t j = 0; j < count; j++) {
+			run[j] = (void *)tag;
+		}
+		for (uint32_t j = 0; j < count; j++) {
+			if (run[j] != (void *)tag) {
+				atomic_fetch_add(&bad_reads, 1);
+			}
+		}
+		oz_mem_blocks_free_contiguous(&item_pool, run, count);
+	}
+	return NULL;
+}
+
+void test_threads_item_pool_runs_do_not_overlap(void)
+{
+	pthread_t tids[N_THREADS];
+
+	atomic_store(&bad_reads, 0);
+	for (uintptr_t i = 0; i < N_THREADS; i++) {
+		pthread_create(&tids[i], NULL, pool_worker, (void *)(i + 1));
+	}
+	for (int i = 0; i < N_THREADS; i++) {
+		pthread_join(tids[i], NULL);
+	}
+	TEST_ASSERT_EQUAL_INT(0, atomic_load(&bad_reads));
+	TEST_ASSERT_EQUAL_UINT32(0, item_pool.num_used);
+}
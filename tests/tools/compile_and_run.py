@@ -1,6 +1,10 @@
 #!/usr/bin/env python3
 # SPDX-License-Identifier: Apache-2.0
-"""Behavior test orchestrator: transpile .m → compile C → run with Unity."""
+"""Behavior test orchestrator: transpile .m → compile C → run with Unity.
+
+With --bench the companion is <stem>_main.c (its own main(), no Unity) and
+every other .c file next to the .m is linked in, so host benchmark runners
+reuse the same transpile and compile steps."""
 
 from __future__ import annotations
 
@@ -23,6 +27,9 @@ GEN_MAIN = REPO_ROOT / "tests" / "tools" / "gen_test_main.py"
 
 POOL_RE = re.compile(r"/\*\s*oz-pool:\s*(.+?)\s*\*/")
 HEAP_RE = re.compile(r"/\*\s*oz-heap\s*\*/")
+LOG_DEFERRED_RE = re.compile(r"/\*\s*oz-log-deferred\s*\*/")
+DEFERRED_DEALLOC_RE = re.compile(r"/\*\s*oz-deferred-dealloc\s*\*/")
+LOG_RE = re.compile(r"/\*\s*oz-log\s*\*/")
 
 
 LLVM_SEARCH_PATHS = [
@@ -64,6 +71,20 @@ def _needs_heap_support(m_path: Path) -> bool:
     return bool(HEAP_RE.search(m_path.read_text()))
 
 
+def _needs_log_deferred(m_path: Path) -> bool:
+    """Check for /* oz-log-deferred */ marker in .m file."""
+    return bool(LOG_DEFERRED_RE.search(m_path.read_text()))
+
+
+def _needs_log_runtime(m_path: Path) -> bool:
+    """Check for /* oz-log */ marker in .m file (link src/OZLog.c)."""
+    return bool(LOG_RE.search(m_path.read_text()))
+
+
+def _needs_deferred_dealloc(m_path: Path) -> bool:
+    """Check for /* oz-deferred-dealloc */ marker in .m file."""
+    return bool(DEFERRED_DEALLOC_RE.search(m_path.read_text()))
+
 
 def _default_pool_sizes(m_path: Path) -> str:
     """Auto-generate default pool sizes (4 blocks per class) from @interface decls."""
@@ -74,9 +95,10 @@ def _default_pool_sizes(m_path: Path) -> str:
     return ",".join(f"{c}=4" for c in classes)
 
 
-def _find_test_file(m_path: Path) -> Path | None:
-    """Find companion _test.c file for a .m file."""
-    test_c = m_path.with_name(m_path.stem + "_test.c")
+def _find_test_file(m_path: Path, bench: bool = False) -> Path | None:
+    """Find companion _test.c (or _main.c for benchmarks) for a .m file."""
+    suffix = "_main.c" if bench else "_test.c"
+    test_c = m_path.with_name(m_path.stem + suffix)
     return test_c if test_c.exists() else None
 
 
@@ -84,14 +106,19 @@ def run_pipeline(m_path: Path, opt: str = "O0", sanitize: str | None = None,
                  compiler: str = "gcc", cflags: str = "",
                  ldflags: str = "",
                  keep_tmp: bool = False,
-                 check_leaks: bool = False) -> subprocess.CompletedProcess:
+                 check_leaks: bool = False,
+                 dispatch_profile: str | None = None,
+                 pool_profile: str | None = None,
+                 bench: bool = False,
+                 bench_json: str | None = None) -> subprocess.CompletedProcess:
     """Run the full transpile → compile → execute pipeline."""
     m_path = m_path.resolve()
-    test_file = _find_test_file(m_path)
+    test_file = _find_test_file(m_path, bench)
     if test_file is None:
+        companion = "_main.c" if bench else "_test.c"
         return subprocess.CompletedProcess(
             args=[], returncode=1,
-            stdout="", stderr=f"error: no companion _test.c for {m_path.name}\n")
+            stdout="", stderr=f"error: no companion {companion} for {m_path.name}\n")
 
     h = hashlib.md5(str(m_path).encode()).hexdigest()[:8]
     tmpdir = Path(tempfile.mkdtemp(prefix=f"oz_btest_{h}_"))
@@ -99,7 +126,10 @@ def run_pipeline(m_path: Path, opt: str = "O0", sanitize: str | None = None,
     try:
         return _run_pipeline_inner(m_path, test_file, tmpdir, opt, sanitize,
                                    compiler, cflags, ldflags,
-                                   check_leaks=check_leaks)
+                                   check_leaks=check_leaks,
+                                   dispatch_profile=dispatch_profile,
+                                   pool_profile=pool_profile,
+                                   bench=bench, bench_json=bench_json)
     finally:
         if not keep_tmp:
             shutil.rmtree(tmpdir, ignore_errors=True)
@@ -109,7 +139,11 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
                         opt: str, sanitize: str | None,
                         compiler: str = "gcc", cflags: str = "",
                         ldflags: str = "",
-                        check_leaks: bool = False) -> subprocess.CompletedProcess:
+                        check_leaks: bool = False,
+                        dispatch_profile: str | None = None,
+                        pool_profile: str | None = None,
+                        bench: bool = False,
+                        bench_json: str | None = None) -> subprocess.CompletedProcess:
     llvm_clang = _find_llvm_clang()
     ast_json = tmpdir / "input.ast.json"
 
@@ -126,6 +160,8 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
     oz_src = REPO_ROOT / "src"
     stubs_dir = REPO_ROOT / "tests" / "behavior" / "include" / "stubs"
     zephyr_stubs = REPO_ROOT / "tests" / "behavior" / "include" / "zephyr_stubs"
+    log_deferred = _needs_log_deferred(m_path)
+    defines = ["-DCONFIG_OBJZ_LOG_DEFERRED"] if log_deferred else []
 
     result = subprocess.run(
         [llvm_clang, "-Xclang", "-ast-dump=json", "-fsyntax-only",
@@ -137,6 +173,7 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
          "-I", str(inc_dir),
          "-I", str(oz_hdr),
          "-I", str(oz_src),
+         *defines,
          str(m_path)],
         capture_output=True, text=True)
     if result.returncode != 0:
@@ -158,6 +195,14 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
         transpile_cmd.extend(["--pool-sizes", pool_sizes])
     if heap_support:
         transpile_cmd.append("--heap-support")
+    if log_deferred:
+        transpile_cmd.append("--log-deferred")
+    if _needs_deferred_dealloc(m_path):
+        transpile_cmd.append("--deferred-dealloc")
+    if dispatch_profile:
+        transpile_cmd.append("--dispatch-profile")
+    if pool_profile:
+        transpile_cmd.append("--pool-stats")
 
     result = subprocess.run(
         transpile_cmd,
@@ -169,23 +214,29 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
             stdout=result.stdout,
             stderr=f"Transpile failed:\n{result.stderr}")
 
-    # Step 3: Generate test_main.c
-    test_main = tmpdir / "test_main.c"
-    result = subprocess.run(
-        [sys.executable, str(GEN_MAIN),
-         "--scan", str(test_file),
-         "--output", str(test_main)],
-        capture_output=True, text=True)
-    if result.returncode != 0:
-        return subprocess.CompletedProcess(
-            args=result.args, returncode=1,
-            stdout=result.stdout,
-            stderr=f"gen_test_main failed:\n{result.stderr}")
+    # Step 3: Generate test_main.c (benchmarks bring their own main)
+    if not bench:
+        test_main = tmpdir / "test_main.c"
+        result = subprocess.run(
+            [sys.executable, str(GEN_MAIN),
+             "--scan", str(test_file),
+             "--output", str(test_main)],
+            capture_output=True, text=True)
+        if result.returncode != 0:
+            return subprocess.CompletedProcess(
+                args=result.args, returncode=1,
+                stdout=result.stdout,
+                stderr=f"gen_test_main failed:\n{result.stderr}")
 
     # Step 4: Compile
     c_files = sorted(glob.glob(str(tmpdir / "*.c")) +
                       glob.glob(str(tmpdir / "Foundation" / "*.c")))
-    all_sources = c_files + [str(test_file), str(UNITY_DIR / "unity.c")]
+    if bench:
+        all_sources = c_files + sorted(str(p) for p in m_path.parent.glob("*.c"))
+    else:
+        all_sources = c_files + [str(test_file), str(UNITY_DIR / "unity.c")]
+    if _needs_log_runtime(m_path):
+        all_sources.append(str(oz_src / "OZLog.c"))
     test_bin = tmpdir / "test_bin"
 
     zephyr_stubs = REPO_ROOT / "tests" / "behavior" / "include" / "zephyr_stubs"
@@ -197,8 +248,11 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
                 "-I", str(PAL_INC),
                 "-I", str(zephyr_stubs),
                 "-I", str(UNITY_DIR)]
+    if bench:
+        cc_flags.extend(["-I", str(m_path.parent)])
     if heap_support:
         cc_flags.append("-DOZ_HEAP_SUPPORT")
+    cc_flags.extend(defines)
     if check_leaks and not sanitize:
         cc_flags.extend(["-fsanitize=leak", "-fno-omit-frame-pointer"])
     if sanitize:
@@ -224,10 +278,17 @@ def _run_pipeline_inner(m_path: Path, test_file: Path, tmpdir: Path,
         env["ASAN_OPTIONS"] = "detect_leaks=1"
     elif sanitize:
         env["ASAN_OPTIONS"] = "detect_leaks=0"
+    if dispatch_profile:
+        env["OZ_DISPATCH_PROFILE_OUT"] = str(Path(dispatch_profile).resolve())
+    if pool_profile:
+        env["OZ_POOL_PROFILE_OUT"] = str(Path(pool_profile).resolve())
+    if bench_json:
+        env["OZ_BENCH_JSON"] = str(Path(bench_json).resolve())
 
     return subprocess.run(
         [str(test_bin)],
-        capture_output=True, text=True, timeout=30, env=env)
+        capture_output=True, text=True, timeout=600 if bench else 30,
+        env=env)
 
 
 def main(argv: list[str] | None = None) -> int:
@@ -247,6 +308,17 @@ def main(argv: list[str] | None = None) -> int:
                    help="Enable leak detection (LSan or ASan detect_leaks)")
     p.add_argument("--keep-tmp", action="store_true",
                    help="Keep temporary build directory")
+    p.add_argument("--dispatch-profile", default=None, metavar="FILE",
+                   help="Instrument protocol dispatch and append selector x "
+                        "class hit counts to FILE (input for --dispatch-guards)")
+    p.add_argument("--pool-profile", default=None, metavar="FILE",
+                   help="Instrument slabs and append per-class peak usage "
+                        "to FILE (input for oz_transpile --pool-profile)")
+    p.add_argument("--bench", action="store_true",
+                   help="Build a benchmark: link <stem>_main.c and the other "
+                        ".c files next to the .m instead of Unity")
+    p.add_argument("--bench-json", default=None, metavar="FILE",
+                   help="With --bench, write the JSON report to FILE")
     args = p.parse_args(argv)
 
     check_leaks = args.check_leaks or os.environ.get("OZ_TEST_CHECK_LEAKS") == "1"
@@ -254,7 +326,10 @@ def main(argv: list[str] | None = None) -> int:
                           sanitize=args.sanitize, compiler=args.compiler,
                           cflags=args.cflags, ldflags=args.ldflags,
                           keep_tmp=args.keep_tmp,
-                          check_leaks=check_leaks)
+                          check_leaks=check_leaks,
+                          dispatch_profile=args.dispatch_profile,
+                          pool_profile=args.pool_profile,
+                          bench=args.bench, bench_json=args.bench_json)
     if result.stdout:
         print(result.stdout, end="")
     if result.stderr:
@@ -10,6 +10,7 @@ import os
 import sys
 from pathlib import Path
 
+from .cache import StatDigests, collect_cached, load_run, run_key, save_run
 from .collect import collect, extract_source_generics, is_stub_source, merge_modules
 from .emit import emit
 from .model import OrphanSource
@@ -33,6 +34,25 @@ def parse_args(argv: list[str] | None = None) -> argparse.Namespace:
                    help="Name of the root class (default: OZObject)")
     p.add_argument("--pool-sizes", default="",
                    help="Comma-separated ClassName=N pairs (e.g. OZLed=4,OZRgbLed=2)")
+    p.add_argument("--pool-stats", action="store_true",
+                   help="Count failed slab allocations and emit "
+                        "oz_pool_stats_dump() (host: OZ_POOL_PROFILE_OUT)")
+    p.add_argument("--pool-profile", default="",
+                   help="Pool profile file; size each slab from its "
+                        "recorded peak plus --pool-margin")
+    p.add_argument("--pool-margin", type=int, default=25,
+                   help="Headroom in percent added to profiled peaks "
+                        "(default: 25)")
+    p.add_argument("--mstring-max-size", type=int, default=256,
+                   help="Largest OZMutableString buffer size class in bytes "
+                        "(default: 256); classes double from 32")
+    p.add_argument("--log-specialize", action="store_true",
+                   help="Split literal OZLog() formats at transpile time "
+                        "into per-call-site writers")
+    p.add_argument("--log-deferred", action="store_true",
+                   help="Store OZLog() message ids and raw arguments in a "
+                        "ring buffer; writes Foundation/oz_log_dict.json "
+                        "for oz_transpile.logdecode")
     p.add_argument("--item-pool-size", type=int, default=None,
                    help="Override auto-computed sys_mem_blocks pool size for "
                         "array/dict item slots")
@@ -42,6 +62,34 @@ def parse_args(argv: list[str] | None = None) -> argparse.Namespace:
                    help="Enable allocWithHeap: and heap-aware free")
     p.add_argument("--strict", action="store_true",
                    help="Treat diagnostics as errors")
+    p.add_argument("--arc-optimize", action="store_true",
+                   help="Eliminate redundant retain/release pairs in "
+                        "emitted functions")
+    p.add_argument("--nonatomic-rc", default="",
+                   help="Comma-separated thread-confined classes whose "
+                        "instances (and subclasses) use a non-atomic refcount")
+    p.add_argument("--deferred-dealloc", action="store_true",
+                   help="Queue zero-refcount objects and dealloc them "
+                        "iteratively in bounded batches (no recursion)")
+    p.add_argument("--deferred-release", nargs="?", const="", default=None,
+                   metavar="CLASSES",
+                   help="Emit <Root>_releaseDeferred() and a workqueue-drained "
+                        "release queue; listed classes (and subclasses) "
+                        "always dealloc through it")
+    p.add_argument("--compact-dispatch", action="store_true",
+                   help="Pack protocol vtables into one row-displaced table")
+    p.add_argument("--devirtualize", action="store_true",
+                   help="Devirtualize protocol sends using class-hierarchy "
+                        "and instantiated-type analysis")
+    p.add_argument("--dispatch-profile", action="store_true",
+                   help="Instrument OZ_PROTOCOL_SEND to record selector x "
+                        "class hits (host builds, see OZ_DISPATCH_PROFILE_OUT)")
+    p.add_argument("--dispatch-guards", default="",
+                   help="Dispatch profile file; guard each profiled "
+                        "polymorphic send with its dominant receiver class")
+    p.add_argument("--cache-dir", default="",
+                   help="Reuse collected ASTs and skip the run entirely when "
+                        "no input changed (content hashes kept here)")
     return p.parse_args(argv)
 
 
@@ -57,6 +105,54 @@ def parse_pool_sizes(raw: str) -> dict[str, int]:
     return result
 
 
+def parse_pool_profile(text: str, margin: int = 25) -> dict[str, int]:
+    """Size slabs from a pool profile written by --pool-stats builds.
+
+    Each line is "<ClassName> <peak> <blocks> <failures>"; blank lines and
+    lines starting with '#' are ignored.  A run that hit failures was
+    short by at least that many blocks, so its demand is peak + failures.
+    The largest demand over all runs (profiles from several binaries can
+    be concatenated) is scaled by margin percent and rounded up; classes
+    never allocated keep one block.
+    """
+    demand: dict[str, int] = {}
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        parts = line.split()
+        if len(parts) != 4 or not all(p.isdigit() for p in parts[1:]):
+            continue
+        name = parts[0]
+        need = int(parts[1]) + int(parts[3])
+        demand[name] = max(demand.get(name, 0), need)
+    return {name: max(1, -(-need * (100 + margin) // 100))
+            for name, need in demand.items()}
+
+
+def parse_dispatch_profile(text: str) -> dict[str, str]:
+    """Pick the dominant receiver class per selector from a dispatch profile.
+
+    Each line is "<selector> <ClassName> <hits>"; blank lines and lines
+    starting with '#' are ignored.  Hits for the same pair are summed so
+    profiles appended by several test binaries can be fed in directly.
+    Ties go to the lexically smaller class name for reproducible output.
+    """
+    hits: dict[str, dict[str, int]] = {}
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        parts = line.split()
+        if len(parts) != 3 or not parts[2].isdigit():
+            continue
+        sel, cls, count = parts
+        per_sel = hits.setdefault(sel, {})
+        per_sel[cls] = per_sel.get(cls, 0) + int(count)
+    return {sel: min(per_sel, key=lambda c: (-per_sel[c], c))
+            for sel, per_sel in hits.items()}
+
+
 def _source_stem(path: str) -> str:
     """Extract the stem from a source path: '/a/b/Producer.m' -> 'Producer'."""
     base = os.path.basename(path)
@@ -95,7 +191,7 @@ def _associate_module_items_with_class(module):
 
     _FOUNDATION_NAMES = {
         "OZObject", "OZString", "OZMutableString", "OZArray",
-        "OZDictionary", "OZQ31", "OZDefer", "OZHeap", "OZSpinLock",
+        "OZDictionary", "OZQ31", "OZDefer", "OZHeap",
     }
     primary = None
     for cls in module.classes.values():
@@ -137,16 +233,53 @@ def _associate_module_items_with_class(module):
     module.user_includes = []
 
 
+def _run_inputs(args: argparse.Namespace) -> list[str]:
+    """Every file a run reads besides its own code and templates."""
+    paths = list(args.input) + list(args.sources or [])
+    for extra in (args.pool_profile, args.dispatch_guards):
+        if extra:
+            paths.append(extra)
+    return paths
+
+
+def _write_manifest(path: str, files: list[str]) -> None:
+    with open(path, "w") as mf:
+        for f in files:
+            mf.write(f + "\n")
+
+
 def main(argv: list[str] | None = None) -> int:
     args = parse_args(argv)
 
     sources = args.sources or []
 
+    # Incremental builds: a run whose arguments and inputs hash the same as
+    # the last successful one would regenerate identical files
+    digests = None
+    key = None
+    if args.cache_dir:
+        os.makedirs(args.cache_dir, exist_ok=True)
+        digests = StatDigests(os.path.join(args.cache_dir, "digests.json"))
+        key = run_key(sys.argv[1:] if argv is None else argv,
+                      _run_inputs(args), digests)
+        prev = load_run(args.cache_dir)
+        if (key is not None and prev.get("key") == key
+                and all(os.path.isfile(f) for f in prev["files"])):
+            digests.save()
+            if args.manifest:
+                _write_manifest(args.manifest, prev["files"])
+            print(f"oz_transpile: {len(prev['files'])} files up to date "
+                  f"in {args.outdir}", file=sys.stderr)
+            return 0
+
     modules = []
     for i, path in enumerate(args.input):
-        with open(path) as f:
-            ast_root = json.load(f)
-        m = collect(ast_root)
+        if args.cache_dir:
+            m = collect_cached(path, digests, args.cache_dir)
+        else:
+            with open(path) as f:
+                ast_root = json.load(f)
+            m = collect(ast_root)
         if i < len(sources):
             src_path = sources[i]
             m.source_stem = _source_stem(src_path)
@@ -200,11 +333,44 @@ def main(argv: list[str] | None = None) -> int:
         return 1
 
     pool_sizes = parse_pool_sizes(args.pool_sizes)
+    if args.pool_profile:
+        try:
+            with open(args.pool_profile) as pf:
+                profiled = parse_pool_profile(pf.read(), args.pool_margin)
+        except OSError as e:
+            print(f"oz_transpile: error: {e}", file=sys.stderr)
+            return 1
+        # Explicit --pool-sizes entries override profiled ones
+        pool_sizes = {**profiled, **pool_sizes}
+    dispatch_guards = {}
+    if args.dispatch_guards:
+        try:
+            with open(args.dispatch_guards) as pf:
+                dispatch_guards = parse_dispatch_profile(pf.read())
+        except OSError as e:
+            print(f"oz_transpile: error: {e}", file=sys.stderr)
+            return 1
     pre_emit_diag_count = len(module.diagnostics)
     files = emit(module, args.outdir, pool_sizes=pool_sizes,
                  root_class=args.root_class,
                  item_pool_size=args.item_pool_size,
-                 heap_support=args.heap_support)
+                 heap_support=args.heap_support,
+                 compact_dispatch=args.compact_dispatch,
+                 devirtualize=args.devirtualize,
+                 dispatch_profile=args.dispatch_profile,
+                 dispatch_guards=dispatch_guards,
+                 arc_optimize=args.arc_optimize,
+                 nonatomic_rc=[n.strip() for n in args.nonatomic_rc.split(",")
+                               if n.strip()],
+                 deferred_dealloc=args.deferred_dealloc,
+                 pool_stats=args.pool_stats,
+                 log_specialize=args.log_specialize,
+                 log_deferred=args.log_deferred,
+                 mstring_max_size=args.mstring_max_size,
+                 deferred_release=(
+                     None if args.deferred_release is None
+                     else [n.strip() for n in args.deferred_release.split(",")
+                           if n.strip()]))
 
     # Check for errors added during emit (e.g., unsupported boxed expr, capturing block)
     if module.errors:
@@ -220,6 +386,10 @@ def main(argv: list[str] | None = None) -> int:
         if args.strict:
             return 1
 
+    if args.verbose:
+        for n in module.notes:
+            print(f"oz_transpile: {n}", file=sys.stderr)
+
     total = len(files)
     is_tty = sys.stderr.isatty()
     for i, f in enumerate(files, 1):
@@ -238,9 +408,12 @@ def main(argv: list[str] | None = None) -> int:
         print(summary, file=sys.stderr)
 
     if args.manifest:
-        with open(args.manifest, "w") as mf:
-            for f in files:
-                mf.write(f + "\n")
+        _write_manifest(args.manifest, files)
+
+    if args.cache_dir:
+        digests.save()
+        if key is not None:
+            save_run(args.cache_dir, key, files)
 
     return 0
 
@@ -0,0 +1,173 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# astdump.py - Clang JSON AST dumps, skipped when nothing they read changed.
+#
+# Usage:
+#   python3 -m oz_transpile.astdump --clang clang --sources a.m b.m \
+#       --asts a.ast.json b.ast.json -- <clang flags...>
+#
+# Each source is dumped with -MD so its header list is known.  A dump is
+# reused when the clang command line, the source and every header it
+# included hash the same as when it was produced; otherwise clang runs
+# again (in parallel across sources).  For X.ast.json, clang stderr goes
+# to X.err.log and the header list to X.d.  A failing clang does not fail
+# the step, as before: the transpiler reports what it could not resolve.
+
+from __future__ import annotations
+
+import argparse
+import hashlib
+import json
+import os
+import subprocess
+import sys
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+
+from .cache import StatDigests
+
+
+def parse_depfile(text: str) -> list[str]:
+    """Prerequisites of a Makefile-syntax depfile written by clang -MD."""
+    text = text.replace("\\\r\n", " ").replace("\\\n", " ")
+    _, sep, rest = text.partition(": ")
+    if not sep:
+        return []
+    deps = []
+    cur = ""
+    i = 0
+    while i < len(rest):
+        ch = rest[i]
+        if ch == "\\" and i + 1 < len(rest) and rest[i + 1] == " ":
+            cur += " "
+            i += 2
+            continue
+        if ch.isspace():
+            if cur:
+                deps.append(cur)
+                cur = ""
+        else:
+            cur += ch
+        i += 1
+    if cur:
+        deps.append(cur)
+    return deps
+
+
+def dump_key(cmd: list[str], deps: list[str],
+             digests: StatDigests) -> str | None:
+    """Key over the command line and the contents of every dependency."""
+    h = hashlib.sha256()
+    h.update("\0".join(cmd).encode())
+    for dep in sorted(set(deps)):
+        digest = digests.digest(dep)
+        if digest is None:
+            return None
+        h.update(f"\0{dep}\0{digest}".encode())
+    return h.hexdigest()
+
+
+def _clang_cmd(clang: str, flags: list[str], src: str) -> list[str]:
+    return [clang, *flags, "-fsyntax-only", "-Xclang", "-ast-dump=json", src]
+
+
+def _sidecar(ast: str, suffix: str) -> Path:
+    """'<dir>/X.ast.json' -> '<dir>/X<suffix>'."""
+    return Path(ast).with_suffix("").with_suffix(suffix)
+
+
+def _run_clang(cmd: list[str], ast: str) -> None:
+    depfile = _sidecar(ast, ".d")
+    depfile.unlink(missing_ok=True)
+    with open(ast, "wb") as out, \
+            open(_sidecar(ast, ".err.log"), "wb") as err:
+        subprocess.run([*cmd, "-MD", "-MF", str(depfile)],
+                       stdout=out, stderr=err)
+
+
+def dump_all(clang: str, flags: list[str], sources: list[str],
+             asts: list[str], jobs: int | None = None) -> list[str]:
+    """Bring every AST dump up to date; returns the sources re-dumped."""
+    if len(sources) != len(asts):
+        raise ValueError("--sources and --asts must have the same length")
+    if not asts:
+        return []
+
+    cache_dir = Path(asts[0]).parent
+    index_path = cache_dir / "oz_ast_cache.json"
+    try:
+        index = json.loads(index_path.read_text())
+    except (OSError, ValueError):
+        index = {}
+    digests = StatDigests(cache_dir / "oz_ast_digests.json")
+
+    stale = []
+    for src, ast in zip(sources, asts):
+        cmd = _clang_cmd(clang, flags, src)
+        entry = index.get(ast)
+        if (entry and Path(ast).is_file()
+                and dump_key(cmd, entry["deps"], digests) == entry["key"]):
+            continue
+        stale.append((src, ast, cmd))
+
+    def run(item):
+        _, ast, cmd = item
+        _run_clang(cmd, ast)
+
+    with ThreadPoolExecutor(max_workers=jobs or os.cpu_count()) as pool:
+        list(pool.map(run, stale))
+
+    for src, ast, cmd in stale:
+        index.pop(ast, None)
+        try:
+            deps = parse_depfile(_sidecar(ast, ".d").read_text())
+        except OSError:
+            continue  # No header list: never reuse this dump
+        key = dump_key(cmd, [src, *deps], digests)
+        if key is not None:
+            index[ast] = {"key": key, "deps": [src, *deps]}
+
+    digests.save()
+    index_path.write_text(json.dumps(index, indent=1) + "\n")
+    return [src for src, _, _ in stale]
+
+
+def main(argv: list[str] | None = None) -> int:
+    argv = sys.argv[1:] if argv is None else argv
+    flags: list[str] = []
+    if "--" in argv:
+        split = argv.index("--")
+        argv, flags = argv[:split], argv[split + 1:]
+
+    p = argparse.ArgumentParser(
+        prog="oz_transpile.astdump",
+        description="Dump Clang JSON ASTs, reusing unchanged dumps",
+    )
+    p.add_argument("--clang", required=True, help="Clang executable")
+    p.add_argument("--sources", nargs="+", required=True,
+                   help="Objective-C sources to dump")
+    p.add_argument("--asts", nargs="+", required=True,
+                   help="AST output paths (same order as --sources)")
+    p.add_argument("-j", "--jobs", type=int, default=None,
+                   help="Parallel clang processes (default: CPU count)")
+    p.add_argument("--verbose", action="store_true",
+                   help="List the sources that were re-dumped")
+    args = p.parse_args(argv)
+
+    try:
+        dumped = dump_all(args.clang, flags, args.sources, args.asts,
+                          args.jobs)
+    except (OSError, ValueError) as e:
+        print(f"oz_transpile.astdump: error: {e}", file=sys.stderr)
+        return 1
+    if args.verbose:
+        for src in dumped:
+            print(f"oz_transpile.astdump: {os.path.basename(src)}",
+                  file=sys.stderr)
+    print(f"oz_transpile.astdump: {len(dumped)}/{len(args.sources)} "
+          f"AST(s) dumped", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,148 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# cache.py - Content-hash caches for incremental transpilation.
+#
+# Everything here is keyed on file contents (SHA-256), never on mtimes
+# alone, so a checkout or `touch` that leaves bytes unchanged is a hit.
+# Every key also covers the transpiler's own sources and templates:
+# upgrading oz_transpile invalidates all cached results.
+
+from __future__ import annotations
+
+import hashlib
+import json
+import os
+import pickle
+from pathlib import Path
+
+from .collect import collect
+from .model import OZModule
+
+_PKG_DIR = Path(__file__).resolve().parent
+
+_code_digest: str | None = None
+
+
+def file_digest(path: str | Path) -> str:
+    h = hashlib.sha256()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 16), b""):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def code_digest() -> str:
+    """Digest of the transpiler's .py sources and Jinja templates."""
+    global _code_digest
+    if _code_digest is None:
+        h = hashlib.sha256()
+        files = sorted(_PKG_DIR.glob("*.py")) + sorted(
+            (_PKG_DIR / "templates").glob("*.j2"))
+        for p in files:
+            h.update(p.name.encode())
+            h.update(p.read_bytes())
+        _code_digest = h.hexdigest()
+    return _code_digest
+
+
+def _write_if_changed(path: Path, data: bytes) -> None:
+    if path.is_file() and path.read_bytes() == data:
+        return
+    tmp = path.with_name(path.name + ".tmp")
+    tmp.write_bytes(data)
+    os.replace(tmp, path)
+
+
+class StatDigests:
+    """File digests memoized by (mtime_ns, size).
+
+    A file is only re-read when its stat changed, so checking a few
+    hundred headers per build stays cheap.  The table is persisted as
+    JSON next to the cache that uses it.
+    """
+
+    def __init__(self, path: str | Path | None = None):
+        self._path = Path(path) if path else None
+        self._table: dict[str, list] = {}
+        if self._path and self._path.is_file():
+            try:
+                self._table = json.loads(self._path.read_text())
+            except (OSError, ValueError):
+                self._table = {}
+
+    def digest(self, path: str) -> str | None:
+        """Return the content digest of path, or None if it is missing."""
+        try:
+            st = os.stat(path)
+        except OSError:
+            return None
+        entry = self._table.get(path)
+        if entry and entry[0] == st.st_mtime_ns and entry[1] == st.st_size:
+            return entry[2]
+        digest = file_digest(path)
+        self._table[path] = [st.st_mtime_ns, st.st_size, digest]
+        return digest
+
+    def save(self) -> None:
+        if self._path:
+            _write_if_changed(self._path, json.dumps(
+                self._table, sort_keys=True).encode())
+
+
+def run_key(argv: list[str], inputs: list[str],
+            digests: StatDigests) -> str | None:
+    """Key for one transpiler run: arguments plus every input's contents.
+
+    Returns None when an input is missing (nothing to compare against).
+    """
+    h = hashlib.sha256()
+    h.update(code_digest().encode())
+    h.update("\0".join(argv).encode())
+    for path in inputs:
+        digest = digests.digest(path)
+        if digest is None:
+            return None
+        h.update(f"\0{path}\0{digest}".encode())
+    return h.hexdigest()
+
+
+def load_run(cache_dir: str | Path) -> dict:
+    path = Path(cache_dir) / "transpile.json"
+    try:
+        return json.loads(path.read_text())
+    except (OSError, ValueError):
+        return {}
+
+
+def save_run(cache_dir: str | Path, key: str, files: list[str]) -> None:
+    """Record a successful run and the files it generated."""
+    _write_if_changed(Path(cache_dir) / "transpile.json", json.dumps(
+        {"key": key, "files": files}, indent=1).encode() + b"\n")
+
+
+def collect_cached(ast_path: str, digests: StatDigests,
+                   cache_dir: str | Path) -> OZModule:
+    """collect() one AST dump, reusing a pickled result when unchanged.
+
+    The pickle holds only the declarations of the dump's main file, so
+    loading it is much cheaper than parsing the full JSON AST (which
+    includes every Zephyr header the source pulled in).
+    """
+    digest = digests.digest(ast_path)
+    key = f"{code_digest()}:{digest}"
+    cache = Path(cache_dir) / (Path(ast_path).name + ".pickle")
+    if digest is not None and cache.is_file():
+        try:
+            with open(cache, "rb") as f:
+                cached_key, module = pickle.load(f)
+            if cached_key == key:
+                return module
+        except Exception:
+            pass  # Corrupt or from another Python; rebuild below
+
+    with open(ast_path) as f:
+        module = collect(json.load(f))
+    if digest is not None:
+        _write_if_changed(cache, pickle.dumps(
+            (key, module), protocol=pickle.HIGHEST_PROTOCOL))
+    return module
@@ -529,13 +529,21 @@ def _collect_protocol(node: dict, module: OZModule) -> None:
         return
 
     methods = []
+    protocols = [p.get("name", "") for p in node.get("protocols", [])
+                 if p.get("name")]
     for child in node.get("inner", []):
-        if child.get("kind") == "ObjCMethodDecl":
+        ckind = child.get("kind", "")
+        if ckind == "ObjCMethodDecl":
             m = _collect_method(child)
             if m:
                 methods.append(m)
+        elif ckind == "ObjCProtocol":
+            proto_name = child.get("name", "")
+            if proto_name and proto_name not in protocols:
+                protocols.append(proto_name)
 
-    module.protocols[name] = OZProtocol(name=name, methods=methods)
+    module.protocols[name] = OZProtocol(name=name, methods=methods,
+                                        protocols=protocols)
 
 
 def _collect_category(node: dict, module: OZModule) -> None:
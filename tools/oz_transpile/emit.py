@@ -4,6 +4,8 @@
 
 from __future__ import annotations
 
+import codecs
+import json
 import os
 from dataclasses import dataclass, field
 from io import StringIO
@@ -11,6 +13,7 @@ from io import StringIO
 from jinja2 import Environment, FileSystemLoader
 
 import re
+import struct
 from pathlib import Path
 
 import tree_sitter_objc as tsobjc
@@ -43,6 +46,51 @@ class _EmitCtx:
 # Populated by _find_owning_return_methods() at the start of emit().
 _owning_return_methods: set[tuple[str, str]] = set()
 
+# Module-level set of classes that are ever instantiated, used by the
+# --devirtualize pass.  None disables devirtualization (default, or when an
+# allocation site with a dynamic receiver makes the set unknowable).
+_instantiated_classes: set[str] | None = None
+
+# Module-level selector -> class map for --dispatch-guards: polymorphic
+# sends of these selectors test the profiled receiver class first.
+_dispatch_guards: dict[str, str] = {}
+
+# Maximum number of reachable implementations lowered to an inline
+# class_id compare chain instead of the const vtable lookup.
+_DEVIRT_MAX_TARGETS = 3
+
+# Module-level switch for the --arc-optimize pass: each emitted function
+# body is run through _arc_optimize_body() before it is written out.
+_arc_optimize: bool = False
+
+# Module-level set of thread-confined classes (--nonatomic-rc), closed
+# under subclassing.  Their instances use a plain refcount increment.
+_nonatomic_rc_classes: set[str] = set()
+
+# Module-level switch for --deferred-dealloc: the root release pushes dead
+# objects onto an intrusive pending list drained in bounded batches.
+_deferred_dealloc: bool = False
+
+# Module-level --deferred-release state: None when disabled, otherwise the
+# classes (closed under subclassing) whose last release always goes through
+# the MPSC release queue drained on the workqueue.
+_deferred_release_classes: set[str] | None = None
+
+# Module-level switch for --pool-stats: failed slab allocations are counted
+# per class and oz_pool_stats_dump() reports each slab's high-water mark.
+_pool_stats: bool = False
+
+# Module-level switch for --log-specialize: OZLog() calls with a literal
+# format are split at transpile time into a per-call-site writer.
+_log_specialize: bool = False
+
+# Module-level --log-deferred state: specialised writers copy raw arguments
+# into the binary log ring instead of formatting text.  Each distinct format
+# gets an ID; _log_messages is written out as oz_log_dict.json.
+_log_deferred: bool = False
+_log_ids: dict[bytes, int] = {}
+_log_messages: list[dict] = []
+
 
 def _create_env() -> Environment:
     """Create Jinja2 environment loading templates from the templates/ directory."""
@@ -65,28 +113,6 @@ def _render(env: Environment, template_name: str, context: dict,
     return path
 
 
-def _inject_oz_spinlock(module: OZModule, root_class: str) -> None:
-    """Add synthetic OZSpinLock class if any @synchronized is used."""
-    counts = _count_alloc_calls(module)
-    if counts.get("OZSpinLock", 0) == 0:
-        return
-    if "OZSpinLock" in module.classes:
-        return
-    max_id = max((c.class_id for c in module.classes.values()), default=-1)
-    module.classes["OZSpinLock"] = OZClass(
-        name="OZSpinLock",
-        superclass=root_class,
-        ivars=[
-            OZIvar("_lock", OZType("oz_spinlock_t")),
-            OZIvar("_key", OZType("oz_spinlock_key_t")),
-            OZIvar("_obj", OZType("OZObject *")),
-        ],
-        class_id=max_id + 1,
-        base_depth=1,
-        is_foundation=True,
-    )
-
-
 def _header_stem(cls: OZClass) -> str:
     """Return the file stem for a class: source_stem if set, else class name."""
     return cls.source_stem or cls.name
@@ -135,7 +161,7 @@ def _associate_module_items(module: OZModule) -> None:
 """Known foundation class names auto-tagged when --sources is not provided."""
 _FOUNDATION_NAMES = frozenset({
     "OZObject", "OZString", "OZMutableString", "OZArray", "OZDictionary",
-    "OZQ31", "OZDefer", "OZHeap", "OZSpinLock",
+    "OZQ31", "OZDefer", "OZHeap",
 })
 
 
@@ -151,7 +177,19 @@ def _ensure_foundation_tags(module: OZModule, root_class: str) -> None:
 def emit(module: OZModule, outdir: str, pool_sizes: dict[str, int] | None = None,
          root_class: str = "OZObject",
          item_pool_size: int | None = None,
-         heap_support: bool = False) -> list[str]:
+         heap_support: bool = False,
+         compact_dispatch: bool = False,
+         devirtualize: bool = False,
+         dispatch_profile: bool = False,
+         dispatch_guards: dict[str, str] | None = None,
+         arc_optimize: bool = False,
+         nonatomic_rc: list[str] | None = None,
+         deferred_dealloc: bool = False,
+         deferred_release: list[str] | None = None,
+         pool_stats: bool = False,
+         log_specialize: bool = False,
+         log_deferred: bool = False,
+         mstring_max_size: int = 256) -> list[str]:
     """Generate C files from OZModule. Returns list of generated file paths."""
     os.makedirs(outdir, exist_ok=True)
     foundation_dir = os.path.join(outdir, "Foundation")
@@ -160,13 +198,31 @@ def emit(module: OZModule, outdir: str, pool_sizes: dict[str, int] | None = None
     files = []
 
     _associate_module_items(module)
-    _inject_oz_spinlock(module, root_class)
     _ensure_foundation_tags(module, root_class)
 
     # Pre-analyze which methods return +1 (owning) references so callers
     # don't add a redundant retain.
-    global _owning_return_methods
+    global _owning_return_methods, _instantiated_classes, _dispatch_guards
+    global _arc_optimize, _nonatomic_rc_classes, _deferred_dealloc
+    global _deferred_release_classes, _pool_stats, _log_specialize
+    global _log_deferred, _log_ids, _log_messages
     _owning_return_methods = _find_owning_return_methods(module)
+    _instantiated_classes = (_find_instantiated_classes(module)
+                             if devirtualize else None)
+    _dispatch_guards = {sel: cls for sel, cls in (dispatch_guards or {}).items()
+                        if cls in module.classes}
+    _arc_optimize = arc_optimize
+    _nonatomic_rc_classes = _subclass_closure(module, nonatomic_rc or [],
+                                              "--nonatomic-rc")
+    _deferred_dealloc = deferred_dealloc
+    _pool_stats = pool_stats
+    _log_specialize = log_specialize or log_deferred
+    _log_deferred = log_deferred
+    _log_ids = {}
+    _log_messages = []
+    _deferred_release_classes = (
+        None if deferred_release is None
+        else _subclass_closure(module, deferred_release, "--deferred-release"))
 
     # Compute pool sizes and item pool count early (needed by per-class templates)
     auto_counts = _count_alloc_calls(module)
@@ -181,14 +237,24 @@ def emit(module: OZModule, outdir: str, pool_sizes: dict[str, int] | None = None
         return _pool_sizes.get(cls_name,
                                max(auto_counts.get(cls_name, 0), 1))
 
+    mstring_pools = _mstring_pools(module, _pool_sizes, mstring_max_size)
+
+    layout = _dispatch_table_layout(module, compact_dispatch)
+    module.notes.append(_dispatch_table_report(layout))
     files.append(_render(env, "oz_dispatch.h.j2",
                          _dispatch_header_ctx(module, root_class,
-                                              _item_pool_count),
+                                              _item_pool_count,
+                                              layout=layout,
+                                              dispatch_profile=dispatch_profile,
+                                              mstring_pools=mstring_pools),
                          foundation_dir, "oz_dispatch.h"))
     files.append(_render(env, "oz_dispatch.c.j2",
                          _dispatch_source_ctx(module, root_class,
                                               _item_pool_count,
-                                              heap_support=heap_support),
+                                              heap_support=heap_support,
+                                              layout=layout,
+                                              dispatch_profile=dispatch_profile,
+                                              mstring_pools=mstring_pools),
                          foundation_dir, "oz_dispatch.c"))
 
     # Group classes by source stem for per-file emission
@@ -255,15 +321,35 @@ def emit(module: OZModule, outdir: str, pool_sizes: dict[str, int] | None = None
             files.append(_render(env, "orphan_source.c.j2",
                                  ctx_dict, outdir, f"{orphan.stem}_ozm.c"))
 
+    if _log_deferred:
+        files.append(_write_log_dict(module, foundation_dir))
+
     return files
 
 
+def _write_log_dict(module: OZModule, foundation_dir: str) -> str:
+    """Write oz_log_dict.json: message IDs and class IDs for logdecode."""
+    classes = sorted(module.classes.values(), key=lambda c: c.class_id)
+    data = {
+        "version": 1,
+        "classes": [{"id": c.class_id, "name": c.name,
+                     "super": c.superclass} for c in classes],
+        "messages": _log_messages,
+    }
+    path = os.path.join(foundation_dir, "oz_log_dict.json")
+    _write_file(path, json.dumps(data, indent=1) + "\n")
+    return path
+
+
 # ---------------------------------------------------------------------------
 # oz_dispatch.h
 # ---------------------------------------------------------------------------
 
 def _dispatch_header_ctx(module: OZModule, root_class: str = "OZObject",
-                         item_pool_count: int = 0) -> dict:
+                         item_pool_count: int = 0,
+                         layout: dict | None = None,
+                         dispatch_profile: bool = False,
+                         mstring_pools: list[dict] | None = None) -> dict:
     """Build template context for oz_dispatch.h."""
     classes = sorted(module.classes.values(), key=lambda c: c.class_id)
 
@@ -287,7 +373,8 @@ def _dispatch_header_ctx(module: OZModule, root_class: str = "OZObject",
         )
         macro_params = ", ".join(["obj"] + [p.name for p in m.params])
         proto_sels.append({
-            "c_sel": c_sel, "ret": ret, "param_types": param_types,
+            "sel": sel, "c_sel": c_sel, "ret": ret,
+            "param_types": param_types,
             "call_args": call_args, "macro_params": macro_params,
         })
 
@@ -320,35 +407,119 @@ def _dispatch_header_ctx(module: OZModule, root_class: str = "OZObject",
         "item_pool_count": item_pool_count,
         "dispatch_includes": dispatch_includes,
         "initialize_classes": module.initialize_classes,
+        "protocol_ids": _protocol_ids(module),
+        "proto_words": _protocol_words(module),
+        "compact": layout is not None and layout["compact"],
+        "sel_offsets": layout["offsets"] if layout else {},
+        "table_size": layout["table_size"] if layout else 0,
+        "dispatch_profile": dispatch_profile,
+        "has_synchronized": _uses_synchronized(module),
+        "pool_stats": _pool_stats,
+        "mstring_pools": mstring_pools or [],
+        "log_specialize": _log_specialize,
+        "log_deferred": _log_deferred,
     }
 
 
 def _dispatch_source_ctx(module: OZModule, root_class: str = "OZObject",
                          item_pool_count: int = 0,
-                         heap_support: bool = False) -> dict:
+                         heap_support: bool = False,
+                         layout: dict | None = None,
+                         dispatch_profile: bool = False,
+                         mstring_pools: list[dict] | None = None) -> dict:
     """Build template context for oz_dispatch.c."""
     sorted_classes = sorted(module.classes.values(), key=lambda c: c.class_id)
 
+    subtree_end = _class_subtree_end(module)
+    proto_ids = _protocol_ids(module)
+    proto_words = _protocol_words(module)
     classes = []
     for cls in sorted_classes:
         super_id = (f"OZ_CLASS_{cls.superclass}"
                     if cls.superclass and cls.superclass in module.classes
                     else "OZ_CLASS_COUNT")
+        conforms = _class_conformance(cls, module)
+        words = [0] * proto_words
+        for proto in conforms:
+            pid = proto_ids.index(proto)
+            words[pid >> 5] |= 1 << (pid & 31)
         classes.append({"name": cls.name, "super_id_expr": super_id,
+                        "subtree_end": subtree_end[cls.name],
+                        "proto_words": [f"0x{w:08x}u" for w in words],
+                        "proto_names": sorted(conforms),
                         "header_stem": _header_stem(cls)})
 
-    # Collect unique protocol selectors (instance methods only)
-    proto_sels_map: dict[str, OZMethod] = {}
+    if layout is None:
+        layout = _dispatch_table_layout(module)
+
+    # Compact mode: one shared table, entries sorted by slot index
+    compact_slots = []
+    if layout["compact"]:
+        for sel in layout["vtable_sels"]:
+            off = layout["offsets"][sel["c_sel"]]
+            for entry in sel["entries"]:
+                compact_slots.append({
+                    "c_sel": sel["c_sel"],
+                    "cls_name": entry["cls_name"],
+                    "impl_name": entry["impl_name"],
+                    "slot": off + entry["class_id"],
+                })
+        compact_slots.sort(key=lambda e: e["slot"])
+
+    return {
+        "classes": classes,
+        "vtable_sels": layout["vtable_sels"],
+        "compact": layout["compact"],
+        "compact_slots": compact_slots,
+        "has_protocols": bool(proto_ids),
+        "dispatch_profile": dispatch_profile,
+        "profile_sels": sorted(_protocol_selectors(module)),
+        "root_class": root_class,
+        "item_pool_count": item_pool_count,
+        "initialize_classes": module.initialize_classes,
+        "heap_support": heap_support,
+        "has_synchronized": _uses_synchronized(module),
+        "pool_stats": _pool_stats,
+        "mstring_pools": mstring_pools or [],
+        "log_deferred": _log_deferred,
+        "log_encode": any(m.selector == "encode:maxLength:"
+                          for c in module.classes.values() for m in c.methods),
+    }
+
+
+
+# ---------------------------------------------------------------------------
+# Dispatch table layout (full per-selector arrays or row-displaced shared table)
+# ---------------------------------------------------------------------------
+
+# Target pointer width used for the --verbose .rodata size report
+_DISPATCH_PTR_BYTES = 4
+
+
+def _protocol_selectors(module: OZModule) -> set[str]:
+    """Unique protocol-dispatched selectors (instance methods only)."""
+    sels: set[str] = set()
     for cls in module.classes.values():
         for m in cls.methods:
-            if (m.dispatch == DispatchKind.PROTOCOL
-                    and not m.is_class_method
-                    and m.selector not in proto_sels_map):
-                proto_sels_map[m.selector] = m
+            if m.dispatch == DispatchKind.PROTOCOL and not m.is_class_method:
+                sels.add(m.selector)
+    return sels
+
+
+def _dispatch_table_layout(module: OZModule, compact: bool = False) -> dict:
+    """Compute protocol vtable rows and, in compact mode, selector offsets.
+
+    Compact mode packs every selector row into one shared table using
+    row displacement: each selector gets the lowest offset at which its
+    non-NULL entries land on free slots, so lookup stays a single indexed
+    load at ``offset + class_id``.  Rows are placed densest first.  The
+    table is padded by OZ_CLASS_COUNT so any class_id stays in bounds.
+    """
+    sorted_classes = sorted(module.classes.values(), key=lambda c: c.class_id)
 
     # Build vtable selectors grouped by selector for const array emission
     vtable_sels = []
-    for sel_name in sorted(proto_sels_map.keys()):
+    for sel_name in sorted(_protocol_selectors(module)):
         c_sel = _selector_to_c(sel_name)
         entries = []
         for cls in sorted_classes:
@@ -357,19 +528,96 @@ def _dispatch_source_ctx(module: OZModule, root_class: str = "OZObject",
                 entries.append({
                     "cls_name": cls.name,
                     "impl_name": impl_cls.name,
+                    "class_id": cls.class_id,
                 })
         vtable_sels.append({"c_sel": c_sel, "entries": entries})
 
+    class_count = len(module.classes)
+    full_slots = len(vtable_sels) * class_count
+    offsets: dict[str, int] = {}
+    table_size = 0
+    if compact and vtable_sels:
+        used: set[int] = set()
+        rows = sorted(vtable_sels,
+                      key=lambda v: (-len(v["entries"]), v["c_sel"]))
+        for row in rows:
+            ids = [e["class_id"] for e in row["entries"]]
+            off = 0
+            while any(off + i in used for i in ids):
+                off += 1
+            used.update(off + i for i in ids)
+            offsets[row["c_sel"]] = off
+        table_size = max(offsets.values()) + class_count
+
     return {
-        "classes": classes,
+        "compact": compact and bool(vtable_sels),
         "vtable_sels": vtable_sels,
-        "root_class": root_class,
-        "item_pool_count": item_pool_count,
-        "initialize_classes": module.initialize_classes,
-        "heap_support": heap_support,
+        "offsets": offsets,
+        "table_size": table_size,
+        "full_slots": full_slots,
     }
 
 
+def _dispatch_table_report(layout: dict) -> str:
+    """One-line .rodata size summary for the protocol dispatch tables."""
+    full = layout["full_slots"] * _DISPATCH_PTR_BYTES
+    msg = (f"dispatch tables: {len(layout['vtable_sels'])} selectors, "
+           f"{full} bytes full")
+    if layout["compact"]:
+        packed = layout["table_size"] * _DISPATCH_PTR_BYTES
+        msg += f" -> {packed} bytes compact"
+    return msg
+
+
+def _protocol_ids(module: OZModule) -> list[str]:
+    """All protocols known to the module, in OZ_PROTO_* id order."""
+    names = set(module.protocols)
+    for proto in module.protocols.values():
+        names.update(proto.protocols)
+    for cls in module.classes.values():
+        names.update(cls.protocols)
+    return sorted(names)
+
+
+def _protocol_words(module: OZModule) -> int:
+    """Number of 32-bit words per class in oz_class_protocols[]."""
+    return max(1, (len(_protocol_ids(module)) + 31) // 32)
+
+
+def _class_conformance(cls: OZClass, module: OZModule) -> set[str]:
+    """Protocols a class conforms to, folding in superclasses and the
+    protocols each adopted protocol itself conforms to."""
+    result: set[str] = set()
+    pending: list[str] = []
+    cur: OZClass | None = cls
+    seen_cls: set[str] = set()
+    while cur and cur.name not in seen_cls:
+        seen_cls.add(cur.name)
+        pending.extend(cur.protocols)
+        cur = module.classes.get(cur.superclass) if cur.superclass else None
+    while pending:
+        name = pending.pop()
+        if name in result:
+            continue
+        result.add(name)
+        proto = module.protocols.get(name)
+        if proto:
+            pending.extend(proto.protocols)
+    return result
+
+
+def _class_subtree_end(module: OZModule) -> dict[str, int]:
+    """One past the highest class_id in each class's subtree.
+
+    With preorder ids the subtree of C is exactly [C.class_id, end).
+    """
+    end = {name: cls.class_id + 1 for name, cls in module.classes.items()}
+    for cls in sorted(module.classes.values(), key=lambda c: -c.class_id):
+        sup = cls.superclass
+        if sup and sup in module.classes:
+            end[sup] = max(end[sup], end[cls.name])
+    return end
+
 
 def _has_auto_dealloc(cls: OZClass, module: OZModule) -> bool:
     """Check if a class will get an auto-generated dealloc method."""
@@ -554,14 +802,14 @@ def _class_header_ctx(ctx: _EmitCtx, stem: str | None = None,
         {"suffix": "fixedWithBool_", "c_type": "int8_t", "is_float": False},
     ]
 
-    # Check if any class in the module uses atomic properties — the lock
-    # field lives in the root class so it must be emitted when any class
-    # in the hierarchy needs it.
+    # Check if any class in the module has atomic properties too wide for
+    # lock-free access — the lock field lives in the root class so it must
+    # be emitted when any class in the hierarchy needs it.
     has_atomic_props = False
     if is_root:
         for c in module.classes.values():
             for p in c.properties:
-                if not p.is_nonatomic:
+                if not p.is_nonatomic and not _is_lockfree_type(p.oz_type):
                     has_atomic_props = True
                     break
             if has_atomic_props:
@@ -609,6 +857,12 @@ def _class_header_ctx(ctx: _EmitCtx, stem: str | None = None,
         "has_atomic_props": has_atomic_props,
         "heap_support": heap_support,
         "inline_accessors": inline_accessors,
+        "has_confined": bool(_nonatomic_rc_classes),
+        "deferred_dealloc": _deferred_dealloc,
+        "thread_confined": cls.name in _nonatomic_rc_classes,
+        "release_queue": _deferred_release_classes is not None,
+        "deferred_release": cls.name in (_deferred_release_classes or ()),
+        "pool_stats": _pool_stats,
     }
 
 
@@ -616,6 +870,27 @@ def _class_header_ctx(ctx: _EmitCtx, stem: str | None = None,
 # Synthesized property accessors
 # ---------------------------------------------------------------------------
 
+# Scalar types no wider than a pointer: atomic accessors load/store them
+# directly instead of taking the root _oz_prop_lock.
+_LOCKFREE_SCALARS = frozenset({
+    "BOOL", "bool", "_Bool", "char", "signed char", "unsigned char",
+    "short", "unsigned short", "int", "unsigned int", "unsigned", "long",
+    "unsigned long", "float", "int8_t", "uint8_t", "int16_t", "uint16_t",
+    "int32_t", "uint32_t", "intptr_t", "uintptr_t", "size_t",
+})
+
+
+def _is_lockfree_type(oz_type: OZType) -> bool:
+    """Check whether an atomic property of this type needs no spinlock."""
+    if oz_type.is_block:
+        return False
+    if oz_type.is_object:
+        return True
+    c_type = oz_type.c_type.strip()
+    return (c_type.endswith("*") or c_type.startswith("enum ")
+            or c_type in _LOCKFREE_SCALARS)
+
+
 def _self_lock_chain(cls: OZClass, module: OZModule) -> str:
     """Build 'self->base.base..._oz_prop_lock' for reaching the root lock field."""
     parts = []
@@ -640,9 +915,16 @@ def _emit_synthesized_accessor(cls: OZClass, m: OZMethod,
     root = root_class
 
     lock_expr = _self_lock_chain(cls, module) if (is_atomic and module) else None
+    lockfree = is_atomic and _is_lockfree_type(prop.oz_type)
 
     if is_getter:
-        if is_atomic:
+        if lockfree:
+            out.write("{\n")
+            out.write(f"\t{c_type} val;\n")
+            out.write(f"\toz_atomic_load_field(&self->{ivar}, &val);\n")
+            out.write("\treturn val;\n")
+            out.write("}\n")
+        elif is_atomic:
             out.write("{\n")
             out.write(f"\t{c_type} val = {{0}};\n")
             out.write(f"\tOZ_SPINLOCK(&{lock_expr}) {{\n")
@@ -658,13 +940,11 @@ def _emit_synthesized_accessor(cls: OZClass, m: OZMethod,
         param_name = m.params[0].name
         if is_strong_obj:
             if is_atomic:
+                # Object pointers are always word-sized: swap, never lock
                 out.write("{\n")
-                out.write(f"\t{c_type} old = {{0}};\n")
                 out.write(f"\t{root}_retain((struct {root} *){param_name});\n")
-                out.write(f"\tOZ_SPINLOCK(&{lock_expr}) {{\n")
-                out.write(f"\t\told = self->{ivar};\n")
-                out.write(f"\t\tself->{ivar} = {param_name};\n")
-                out.write("\t}\n")
+                out.write(f"\t{c_type} old = ({c_type})oz_atomic_ptr_swap(\n")
+                out.write(f"\t\t(void **)&self->{ivar}, (void *){param_name});\n")
                 out.write(f"\t{root}_release((struct {root} *)old);\n")
                 out.write("}\n")
             else:
@@ -675,7 +955,11 @@ def _emit_synthesized_accessor(cls: OZClass, m: OZMethod,
                 out.write(f"\t{root}_release((struct {root} *)old);\n")
                 out.write("}\n")
         else:
-            if is_atomic:
+            if lockfree:
+                out.write("{\n")
+                out.write(f"\toz_atomic_store_field(&self->{ivar}, &{param_name});\n")
+                out.write("}\n")
+            elif is_atomic:
                 out.write("{\n")
                 out.write(f"\tOZ_SPINLOCK(&{lock_expr}) {{\n")
                 out.write(f"\t\tself->{ivar} = {param_name};\n")
@@ -755,7 +1039,7 @@ def _class_source_ctx(ctx: _EmitCtx, stem: str | None = None,
             buf.write("{\n}\n")
         method_bodies.append(buf.getvalue().rstrip("\n"))
 
-    if not has_user_dealloc and cls.name != "OZSpinLock":
+    if not has_user_dealloc:
         buf = StringIO()
         _emit_auto_dealloc(ctx, buf)
         val = buf.getvalue()
@@ -876,12 +1160,149 @@ def _orphan_source_ctx(orphan: OrphanSource, module: OZModule,
 # Root class retain/release
 # ---------------------------------------------------------------------------
 
+def _subclass_closure(module: OZModule, names: list[str],
+                      option: str) -> set[str]:
+    """Expand per-class option names (e.g. --nonatomic-rc) to their subclasses."""
+    for name in names:
+        if name not in module.classes:
+            module.diagnostics.append(
+                f"warning: {option} class '{name}' not found")
+    result: set[str] = set()
+    for cls in module.classes.values():
+        cur: OZClass | None = cls
+        while cur is not None:
+            if cur.name in names:
+                result.add(cls.name)
+                break
+            cur = module.classes.get(cur.superclass or "")
+    return result
+
+
+def _emit_rc_owner_check(out: StringIO, tabs: str) -> None:
+    """Emit the OZ_NONATOMIC_RC_CHECK owner-thread assertion."""
+    out.write("#ifdef OZ_NONATOMIC_RC_CHECK\n")
+    out.write(f"{tabs}oz_assert_msg(oz_thread_is_self(self->_oz_owner),\n")
+    out.write(f"{tabs}\t      \"thread-confined object used off its owner thread\");\n")
+    out.write("#endif\n")
+
+
+def _emit_dealloc_queue(cls: OZClass, out: StringIO) -> None:
+    """Emit the deferred-dealloc pending list and its bounded drain.
+
+    A dead object's _refcount slot is reused as the list link.  Only one
+    drain runs at a time; releases that hit zero meanwhile (including the
+    ivar releases inside each dealloc) just push, so a release cascade
+    becomes a loop instead of recursion.  Each drain finalises at most
+    OZ_DEALLOC_DRAIN_BATCH objects; the rest wait for the next one.
+    """
+    name = cls.name
+    out.write(f"static struct {name} *_oz_dealloc_head;\n")
+    out.write("static bool _oz_dealloc_draining;\n")
+    out.write("static oz_spinlock_t _oz_dealloc_lock;\n\n")
+
+    out.write("void oz_dealloc_drain(void)\n")
+    out.write("{\n")
+    out.write("\toz_spinlock_key_t key = oz_spin_lock(&_oz_dealloc_lock);\n")
+    out.write("\tif (_oz_dealloc_draining) {\n")
+    out.write("\t\toz_spin_unlock(&_oz_dealloc_lock, key);\n")
+    out.write("\t\treturn;\n")
+    out.write("\t}\n")
+    out.write("\t_oz_dealloc_draining = true;\n")
+    out.write("\toz_spin_unlock(&_oz_dealloc_lock, key);\n")
+    out.write("\tfor (unsigned int n = 0; n < OZ_DEALLOC_DRAIN_BATCH; n++) {\n")
+    out.write("\t\tkey = oz_spin_lock(&_oz_dealloc_lock);\n")
+    out.write(f"\t\tstruct {name} *obj = _oz_dealloc_head;\n")
+    out.write("\t\tif (obj) {\n")
+    out.write("\t\t\t_oz_dealloc_head = oz_atomic_get_link(&obj->_refcount);\n")
+    out.write("\t\t}\n")
+    out.write("\t\toz_spin_unlock(&_oz_dealloc_lock, key);\n")
+    out.write("\t\tif (!obj) {\n")
+    out.write("\t\t\tbreak;\n")
+    out.write("\t\t}\n")
+    out.write("\t\toz_atomic_init(&obj->_refcount, 0);\n")
+    out.write("\t\tOZ_PROTOCOL_SEND_dealloc(obj);\n")
+    out.write("\t}\n")
+    out.write("\tkey = oz_spin_lock(&_oz_dealloc_lock);\n")
+    out.write("\t_oz_dealloc_draining = false;\n")
+    out.write("\toz_spin_unlock(&_oz_dealloc_lock, key);\n")
+    out.write("}\n\n")
+
+
+def _emit_release_queue(cls: OZClass, out: StringIO) -> None:
+    """Emit the --deferred-release MPSC queue, its drain and work item.
+
+    Producers (any context, including ISRs) push with a CAS loop, linking
+    through the dead object's _refcount slot, and submit the work item.
+    The consumer detaches the whole list with one swap, so it never races
+    producers and needs no lock.
+    """
+    name = cls.name
+    out.write(f"static struct {name} *_oz_release_queue;\n\n")
+
+    out.write("void oz_release_queue_drain(void)\n")
+    out.write("{\n")
+    out.write(f"\tstruct {name} *obj = (struct {name} *)oz_atomic_ptr_swap(\n")
+    out.write("\t\t(void **)&_oz_release_queue, (void *)0);\n")
+    out.write("\twhile (obj) {\n")
+    out.write(f"\t\tstruct {name} *next = oz_atomic_get_link(&obj->_refcount);\n")
+    out.write("\t\toz_atomic_init(&obj->_refcount, 0);\n")
+    out.write("\t\tOZ_PROTOCOL_SEND_dealloc(obj);\n")
+    out.write("\t\tobj = next;\n")
+    out.write("\t}\n")
+    out.write("}\n\n")
+
+    out.write("static void _oz_release_work_handler(oz_work_t *work)\n")
+    out.write("{\n")
+    out.write("\t(void)work;\n")
+    out.write("\toz_release_queue_drain();\n")
+    out.write("}\n\n")
+    out.write("static OZ_WORK_DEFINE(_oz_release_work, _oz_release_work_handler);\n\n")
+
+    out.write(f"static void _oz_release_enqueue(struct {name} *self)\n")
+    out.write("{\n")
+    out.write(f"\tstruct {name} *head;\n")
+    out.write("\tdo {\n")
+    out.write("\t\toz_atomic_load_field(&_oz_release_queue, &head);\n")
+    out.write("\t\toz_atomic_set_link(&self->_refcount, head);\n")
+    out.write("\t} while (!oz_atomic_ptr_cas((void **)&_oz_release_queue,\n")
+    out.write("\t\t\t\t   (void *)head, (void *)self));\n")
+    out.write("\toz_work_submit(&_oz_release_work);\n")
+    out.write("}\n\n")
+
+    out.write(f"void {name}_releaseDeferred(struct {name} *self)\n")
+    out.write("{\n")
+    out.write("\tif (!self || self->_meta.immortal) {\n")
+    out.write("\t\treturn;\n")
+    out.write("\t}\n")
+    out.write("\tif (oz_atomic_dec_and_test(&self->_refcount)) {\n")
+    out.write("\t\tif (self->_meta.deallocating) {\n")
+    out.write("\t\t\treturn;\n")
+    out.write("\t\t}\n")
+    out.write("\t\tself->_meta.deallocating = 1;\n")
+    out.write("\t\t_oz_release_enqueue(self);\n")
+    out.write("\t}\n")
+    out.write("}\n\n")
+
+
 def _emit_root_retain_release(cls: OZClass, module: OZModule,
                               out: StringIO) -> None:
+    confined = bool(_nonatomic_rc_classes)
+    if _deferred_dealloc:
+        _emit_dealloc_queue(cls, out)
+    if _deferred_release_classes is not None:
+        _emit_release_queue(cls, out)
     out.write(f"struct {cls.name} *{cls.name}_retain(struct {cls.name} *self)\n")
     out.write("{\n")
-    out.write("\tif (self) {\n")
-    out.write(f"\t\toz_atomic_inc(&self->_refcount);\n")
+    out.write("\tif (self && !self->_meta.immortal) {\n")
+    if confined:
+        out.write("\t\tif (self->_meta.thread_confined) {\n")
+        _emit_rc_owner_check(out, "\t\t\t")
+        out.write("\t\t\toz_nonatomic_inc(&self->_refcount);\n")
+        out.write("\t\t} else {\n")
+        out.write("\t\t\toz_atomic_inc(&self->_refcount);\n")
+        out.write("\t\t}\n")
+    else:
+        out.write(f"\t\toz_atomic_inc(&self->_refcount);\n")
     out.write("\t}\n")
     out.write("\treturn self;\n")
     out.write("}\n\n")
@@ -894,12 +1315,34 @@ def _emit_root_retain_release(cls: OZClass, module: OZModule,
     out.write("\tif (self->_meta.immortal) {\n")
     out.write("\t\treturn;\n")
     out.write("\t}\n")
-    out.write(f"\tif (oz_atomic_dec_and_test(&self->_refcount)) {{\n")
+    if confined:
+        out.write("\tbool last;\n")
+        out.write("\tif (self->_meta.thread_confined) {\n")
+        _emit_rc_owner_check(out, "\t\t")
+        out.write("\t\tlast = oz_nonatomic_dec_and_test(&self->_refcount);\n")
+        out.write("\t} else {\n")
+        out.write("\t\tlast = oz_atomic_dec_and_test(&self->_refcount);\n")
+        out.write("\t}\n")
+        out.write("\tif (last) {\n")
+    else:
+        out.write(f"\tif (oz_atomic_dec_and_test(&self->_refcount)) {{\n")
     out.write("\t\tif (self->_meta.deallocating) {\n")
     out.write("\t\t\treturn;\n")
     out.write("\t\t}\n")
     out.write("\t\tself->_meta.deallocating = 1;\n")
-    out.write(f"\t\tOZ_PROTOCOL_SEND_dealloc((struct {cls.name} *)self);\n")
+    if _deferred_release_classes:
+        out.write("\t\tif (self->_meta.deferred_release) {\n")
+        out.write("\t\t\t_oz_release_enqueue(self);\n")
+        out.write("\t\t\treturn;\n")
+        out.write("\t\t}\n")
+    if _deferred_dealloc:
+        out.write("\t\toz_spinlock_key_t key = oz_spin_lock(&_oz_dealloc_lock);\n")
+        out.write("\t\toz_atomic_set_link(&self->_refcount, _oz_dealloc_head);\n")
+        out.write("\t\t_oz_dealloc_head = self;\n")
+        out.write("\t\toz_spin_unlock(&_oz_dealloc_lock, key);\n")
+        out.write("\t\toz_dealloc_drain();\n")
+    else:
+        out.write(f"\t\tOZ_PROTOCOL_SEND_dealloc((struct {cls.name} *)self);\n")
     out.write("\t}\n")
     out.write("}\n\n")
 
@@ -935,6 +1378,11 @@ def _emit_root_introspection(cls: OZClass, out: StringIO) -> None:
 def _emit_compound_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
                         indent: int = 0, inline: bool = False,
                         param_retains: list[OZParam] | None = None) -> None:
+    # Function-level bodies are buffered and run through the ARC optimiser
+    arc_out = None
+    if param_retains is not None and _arc_optimize:
+        arc_out, out = out, StringIO()
+
     if inline:
         out.write("{\n")
     else:
@@ -965,10 +1413,20 @@ def _emit_compound_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
 
     out.write("\t" * indent + "}\n")
 
+    if arc_out is not None:
+        _write_arc_optimized(out.getvalue(), arc_out, ctx)
+
+
+_SYNC_GUARD_TYPE = "struct oz_sync_stripe *"
+
 
 def _emit_synchronized_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
                             indent: int) -> None:
-    """Emit @synchronized(obj) { ... } as OZSpinLock RAII block."""
+    """Emit @synchronized(obj) { ... } as a scoped striped-lock guard.
+
+    The guard is tracked like a scope var so every exit path (end of
+    block, return, break, continue) emits the matching oz_sync_exit().
+    """
     inner = node.get("inner", [])
     if len(inner) < 2:
         return
@@ -989,9 +1447,9 @@ def _emit_synchronized_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
 
     ctx.scope_vars.append({})
 
-    out.write(f"{tabs1}struct OZSpinLock *{sync_name} = OZSpinLock_initWithObject("
-              f"OZSpinLock_alloc(), (struct {ctx.root_class} *){obj_buf.getvalue()});\n")
-    ctx.scope_vars[-1][sync_name] = OZType("OZSpinLock *")
+    out.write(f"{tabs1}{_SYNC_GUARD_TYPE}{sync_name} = oz_sync_enter("
+              f"{obj_buf.getvalue()});\n")
+    ctx.scope_vars[-1][sync_name] = OZType(_SYNC_GUARD_TYPE)
 
     if body.get("kind") == "CompoundStmt":
         for child in body.get("inner", []):
@@ -1322,18 +1780,52 @@ def _emit_for_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
     ctx.loop_scope_depth.pop()
 
 
+def _is_direct_array(coll_node: dict, ctx: _EmitCtx) -> bool:
+    """True when a for-in collection is statically an OZArray nobody subclasses."""
+    qt = coll_node.get("type", {}).get("qualType", "")
+    if OZType(qt).c_type != "struct OZArray *":
+        return False
+    module = ctx.module
+    if module is None or "OZArray" not in module.classes:
+        return False
+    return not any(c.superclass == "OZArray" for c in module.classes.values())
+
+
+def _refers_to(node: dict, name: str) -> bool:
+    """Check whether an AST subtree references a variable by name."""
+    if (node.get("kind") == "DeclRefExpr"
+            and node.get("referencedDecl", {}).get("name") == name):
+        return True
+    return any(_refers_to(child, name) for child in node.get("inner", []))
+
+
 def _emit_forin_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
                      indent: int) -> None:
-    """Lower ObjCForCollectionStmt to scoped iterator-based for loop.
+    """Lower ObjCForCollectionStmt to a loop over a stack-allocated cursor.
 
-    for (id obj in [sensor samples]) { body }
+    for (id obj in coll) { body }
     =>
     {
-        struct OZObject *_oz_iterN = (struct OZObject *)OZ_PROTOCOL_SEND_iter(collection);
-        struct OZObject *_oz_recvN = _oz_iterN;
-        for (struct OZObject *obj = OZ_PROTOCOL_SEND_next(_oz_recvN); obj != NULL;
-             obj = OZ_PROTOCOL_SEND_next(_oz_recvN)) { body }
+        struct OZObject *_oz_collN = (struct OZObject *)coll;
+        struct NSFastEnumerationState _oz_stateN = {0};
+        struct OZObject *_oz_bufN[OZ_FORIN_BATCH];
+        unsigned long _oz_nN = 0;
+        for (unsigned long _oz_iN = 0; ; _oz_iN++) {
+            if (_oz_iN >= _oz_nN) {
+                _oz_nN = OZ_PROTOCOL_SEND_countByEnumeratingWithState_...(
+                    _oz_collN, &_oz_stateN, _oz_bufN, OZ_FORIN_BATCH);
+                if (_oz_nN == 0) { break; }
+                _oz_iN = 0;
+            }
+            struct OZObject *obj = _oz_stateN.itemsPtr[_oz_iN];
+            { body }
+        }
     }
+
+    The cursor lives in the caller's frame, so nested loops and concurrent
+    readers of one collection never share iteration state.  A collection
+    statically typed OZArray (with no subclasses in the module) skips
+    dispatch entirely and indexes _items directly.
     """
     tabs = "\t" * indent
     inner = node.get("inner", [])
@@ -1351,39 +1843,62 @@ def _emit_forin_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
     import re
     qt = re.sub(r'\*\s*const\b', '*', qt)
     c_type = OZType(qt).c_type
+    cast = f"({c_type})" if c_type != "struct OZObject *" else ""
 
     coll_buf = StringIO()
     _emit_expr(collection, coll_buf, ctx)
     _flush_pre_stmts(out, ctx, indent)
 
-    iter_tmp = f"_oz_iter{ctx._tmp_counter}"
-    ctx._tmp_counter += 1
-    next_recv = f"_oz_recv{ctx._tmp_counter}"
+    n = ctx._tmp_counter
     ctx._tmp_counter += 1
+    coll_tmp = f"_oz_coll{n}"
+    idx = f"_oz_i{n}"
 
     itabs = "\t" * (indent + 1)
+    btabs = "\t" * (indent + 2)
     out.write(f"{tabs}{{\n")
-    out.write(f"{itabs}struct OZObject *{iter_tmp} = "
-              f"(struct OZObject *)OZ_PROTOCOL_SEND_iter("
-              f"(struct OZObject *){coll_buf.getvalue()});\n")
-    out.write(f"{itabs}struct OZObject *{next_recv} = {iter_tmp};\n")
-    next_call = f"OZ_PROTOCOL_SEND_next({next_recv})"
-    if c_type != "struct OZObject *":
-        next_call = f"({c_type}){next_call}"
-    out.write(f"{itabs}for ({c_type} {var_name} = {next_call}; "
-              f"{var_name} != ((void *)0); "
-              f"{var_name} = {next_call}) ")
+    if _is_direct_array(collection, ctx):
+        out.write(f"{itabs}struct OZArray *{coll_tmp} = "
+                  f"(struct OZArray *){coll_buf.getvalue()};\n")
+        out.write(f"{itabs}for (unsigned int {idx} = 0; "
+                  f"{idx} < {coll_tmp}->_count; {idx}++) {{\n")
+        item = f"{coll_tmp}->_items[{idx}]"
+    else:
+        state = f"_oz_state{n}"
+        buf = f"_oz_buf{n}"
+        count = f"_oz_n{n}"
+        ttabs = "\t" * (indent + 3)
+        out.write(f"{itabs}struct OZObject *{coll_tmp} = "
+                  f"(struct OZObject *){coll_buf.getvalue()};\n")
+        out.write(f"{itabs}struct NSFastEnumerationState {state} = {{0}};\n")
+        out.write(f"{itabs}struct OZObject *{buf}[OZ_FORIN_BATCH];\n")
+        out.write(f"{itabs}unsigned long {count} = 0;\n")
+        out.write(f"{itabs}for (unsigned long {idx} = 0; ; {idx}++) {{\n")
+        out.write(f"{btabs}if ({idx} >= {count}) {{\n")
+        out.write(f"{ttabs}{count} = OZ_PROTOCOL_SEND_"
+                  f"countByEnumeratingWithState_objects_count_(\n"
+                  f"{ttabs}\t{coll_tmp}, &{state}, {buf}, OZ_FORIN_BATCH);\n")
+        out.write(f"{ttabs}if ({count} == 0) {{\n")
+        out.write(f"{ttabs}\tbreak;\n")
+        out.write(f"{ttabs}}}\n")
+        out.write(f"{ttabs}{idx} = 0;\n")
+        out.write(f"{btabs}}}\n")
+        item = f"{state}.itemsPtr[{idx}]"
+    out.write(f"{btabs}{c_type} {var_name} = {cast}{item};\n")
+    if not _refers_to(body, var_name):
+        out.write(f"{btabs}(void){var_name};\n")
 
     ctx.scope_vars.append({var_name: OZType(qt)})
     ctx.loop_scope_depth.append(len(ctx.scope_vars))
     if body.get("kind") == "CompoundStmt":
-        _emit_compound_stmt(body, out, ctx, indent + 1, inline=True)
+        _emit_compound_stmt(body, out, ctx, indent + 2)
     else:
-        out.write("{\n")
-        _emit_stmt(body, out, ctx, indent + 2)
-        out.write(f"{itabs}}}\n")
+        out.write(f"{btabs}{{\n")
+        _emit_stmt(body, out, ctx, indent + 3)
+        out.write(f"{btabs}}}\n")
     ctx.loop_scope_depth.pop()
     ctx.scope_vars.pop()
+    out.write(f"{itabs}}}\n")
     out.write(f"{tabs}}}\n")
 
 
@@ -1416,8 +1931,492 @@ def _boxed_type_category(qt: str) -> tuple[str, bool]:
     return "int", True
 
 
+def _q31_bits_for_mag(mag: int) -> int:
+    """Mirror of _oz_bits_for_mag() in the OZQ31 header."""
+    return min(mag.bit_length(), 31)
+
+
+def _q31_constant(node: dict) -> tuple[int, int] | None:
+    """Fold a literal @42 / @-1.5f / @YES to its (raw, shift) Q31 encoding.
+
+    Follows the runtime OZQ31_fixedWith* encoders bit for bit, including
+    float32 rounding of the literal.  Returns None for non-literal boxed
+    expressions and values outside the int32 range.
+    """
+    inner = node.get("inner", [])
+    if node.get("kind") != "ObjCBoxedExpr" or not inner:
+        return None
+    child = inner[0]
+    negate = False
+    while True:
+        kind = child.get("kind", "")
+        if kind in ("ImplicitCastExpr", "ParenExpr"):
+            child = child.get("inner", [{}])[0]
+        elif (kind == "UnaryOperator" and child.get("opcode") == "-"
+              and not negate):
+            negate = True
+            child = child.get("inner", [{}])[0]
+        else:
+            break
+
+    if kind == "FloatingLiteral":
+        try:
+            val = float(str(child.get("value", "0")).rstrip("fF"))
+        except ValueError:
+            return None
+        val = struct.unpack("f", struct.pack("f", -val if negate else val))[0]
+        if abs(val) >= 2 ** 31:
+            return None
+        if val == 0.0:
+            return 0, 0
+        shift = _q31_bits_for_mag(int(abs(val)))
+        raw = int(val * 2 ** (31 - shift)) if shift < 31 else int(val * 0.5)
+        return raw, shift
+
+    if kind in ("IntegerLiteral", "CharacterLiteral"):
+        try:
+            val = int(str(child.get("value", "0")), 0)
+        except ValueError:
+            return None
+    elif kind == "ObjCBoolLiteralExpr":
+        raw_val = child.get("value", False)
+        if isinstance(raw_val, str):
+            val = 0 if "no" in raw_val.lower() else 1
+        else:
+            val = 1 if raw_val else 0
+    else:
+        return None
+    if negate:
+        val = -val
+    if not -2 ** 31 <= val < 2 ** 31:
+        return None
+    if val == 0:
+        return 0, 0
+    shift = _q31_bits_for_mag(abs(val))
+    raw = (val << (31 - shift)) & 0xFFFFFFFF
+    return raw - (1 << 32) if raw & 0x80000000 else raw, shift
+
+
+def _emit_q31_constant(raw: int, shift: int, out: StringIO,
+                       ctx: _EmitCtx) -> None:
+    """Emit a reference to an immortal static const OZQ31 literal."""
+    key = f"@q31:{raw}:{shift}"
+    if key in ctx._string_dedup:
+        name = ctx._string_dedup[key]
+    else:
+        name = f"_oz_q31_{raw & 0xFFFFFFFF:08x}_{shift}"
+        ctx._string_dedup[key] = name
+        ctx.string_constants.append(
+            f"static const struct OZQ31 {name} = {{"
+            f"{{{{.class_id = OZ_CLASS_OZQ31, .immortal = 1}}, 1}}, "
+            f"{raw}, {shift}}};"
+        )
+    out.write(f"(struct OZQ31 *)&{name}")
+
+
+def _c_string_bytes(raw: str) -> bytes:
+    """Decode the body of a C string literal spelling to its bytes."""
+    return codecs.escape_decode(raw.encode("utf-8"))[0]
+
+
+def _c_string_literal(data: bytes) -> str:
+    """Spell bytes as a C string literal (octal escapes for non-ASCII)."""
+    parts = []
+    for b in data:
+        c = chr(b)
+        if c in '"\\':
+            parts.append("\\" + c)
+        elif c == "\n":
+            parts.append("\\n")
+        elif c == "\t":
+            parts.append("\\t")
+        elif 32 <= b < 127:
+            parts.append(c)
+        else:
+            parts.append(f"\\{b:03o}")
+    return '"' + "".join(parts) + '"'
+
+
+# OZLog() conversions: %% | %.N@ | %@ | %[flags][width][.prec][len]conv,
+# the same grammar OZLog.c accepts at run time.
+_LOG_SPEC_RE = re.compile(
+    rb"%(?:(?P<pct>%)|(?:\.(?P<oprec>\d+))?(?P<obj>@)|"
+    rb"(?P<flags>[-+ #0]*)(?P<width>\d*)(?P<prec>\.\d*)?"
+    rb"(?P<len>hh|h|ll|l|z)?(?P<conv>[diuxXoscp]))")
+
+# Conversions without flags, width, precision or length modifier that
+# have a dedicated writer; every other spec goes through oz_log_fmt().
+_LOG_PLAIN_WRITERS = {
+    "d": "oz_log_int", "i": "oz_log_int", "u": "oz_log_uint",
+    "x": "oz_log_hex", "X": "oz_log_hex",
+    "s": "oz_log_str", "c": "oz_log_char",
+}
+
+
+def _log_arg_type(conv: str, length: str) -> str:
+    """C parameter type that va_arg would read for one conversion."""
+    if conv in "di":
+        return {"l": "long", "ll": "long long", "z": "size_t"}.get(length, "int")
+    if conv in "uxXo":
+        return {"l": "unsigned long", "ll": "unsigned long long",
+                "z": "size_t"}.get(length, "unsigned int")
+    if conv == "s":
+        return "const char *"
+    if conv == "p":
+        return "const void *"
+    return "int"
+
+
+def _split_log_format(fmt: bytes) -> list[tuple] | None:
+    """Split an OZLog() format into segment/argument descriptors.
+
+    Returns ("lit", bytes), ("obj", precision) and ("arg", writer, spec,
+    c_type) entries in order, or None when the format uses something
+    OZLog.c would not accept (%f, %*d, a trailing '%').
+    """
+    parts: list[tuple] = []
+    lit = b""
+    pos = 0
+    while True:
+        pct = fmt.find(b"%", pos)
+        if pct < 0:
+            lit += fmt[pos:]
+            break
+        lit += fmt[pos:pct]
+        m = _LOG_SPEC_RE.match(fmt, pct)
+        if m is None:
+            return None
+        pos = m.end()
+        if m.group("pct"):
+            lit += b"%"
+            continue
+        if lit:
+            parts.append(("lit", lit))
+            lit = b""
+        if m.group("obj"):
+            oprec = m.group("oprec")
+            parts.append(("obj", int(oprec) if oprec is not None else -1))
+            continue
+        conv = m.group("conv").decode()
+        length = (m.group("len") or b"").decode()
+        spec = m.group(0).decode("latin-1")
+        writer = "oz_log_fmt"
+        if spec == "%" + conv and conv in _LOG_PLAIN_WRITERS:
+            writer = _LOG_PLAIN_WRITERS[conv]
+        parts.append(("arg", writer, spec, _log_arg_type(conv, length)))
+    if lit:
+        parts.append(("lit", lit))
+    return parts
+
+
+def _log_arg_enc(spec: str) -> str:
+    """Deferred-log encoding of one conversion (see logdecode.py)."""
+    conv = spec[-1]
+    wide = "l" in spec[:-1] or "z" in spec[:-1]
+    if conv == "s":
+        return "str"
+    if conv == "p":
+        return "ptr"
+    if conv in "di" and wide:
+        return "i64"
+    if conv in "uxXo" and wide:
+        return "u64"
+    return "i32" if conv in "dic" else "u32"
+
+
+def _log_message_id(fmt: bytes, parts: list[tuple]) -> int:
+    """ID of a deferred-log format; identical formats share one entry."""
+    if fmt not in _log_ids:
+        _log_ids[fmt] = len(_log_messages)
+        dict_parts = []
+        for part in parts:
+            if part[0] == "lit":
+                dict_parts.append(["lit", part[1].decode("latin-1")])
+            elif part[0] == "obj":
+                dict_parts.append(["obj", part[1]])
+            else:
+                dict_parts.append(["arg", part[2], _log_arg_enc(part[2])])
+        _log_messages.append({"id": _log_ids[fmt],
+                              "fmt": fmt.decode("latin-1"),
+                              "parts": dict_parts})
+    return _log_ids[fmt]
+
+
+def _log_text_body(parts: list[tuple]) -> list[str]:
+    """Writer body for --log-specialize: format into a stack buffer."""
+    body = ["\tstruct oz_log_buf b;", "", "\tb.pos = 0;"]
+    arg_idx = 0
+    for part in parts:
+        if part[0] == "lit":
+            body.append(f"\toz_log_lit(&b, {_c_string_literal(part[1])}, "
+                        f"{len(part[1])});")
+            continue
+        arg = f"a{arg_idx}"
+        arg_idx += 1
+        if part[0] == "obj":
+            body.append(f"\toz_log_obj(&b, {arg}, {part[1]});")
+        elif part[1] == "oz_log_fmt":
+            body.append(f'\toz_log_fmt(&b, "{part[2]}", {arg});')
+        elif part[1] == "oz_log_hex":
+            body.append(f"\toz_log_hex(&b, {arg}, "
+                        f"{int(part[2] == '%X')});")
+        else:
+            body.append(f"\t{part[1]}(&b, {arg});")
+    body.append("\toz_log_end(&b);")
+    return body
+
+
+def _log_deferred_body(parts: list[tuple], msg_id: int) -> list[str]:
+    """Writer body for --log-deferred: copy raw arguments into a record."""
+    fixed = 0
+    strs = objs = 0
+    stores = []
+    arg_idx = 0
+    for part in parts:
+        if part[0] == "lit":
+            continue
+        arg = f"a{arg_idx}"
+        arg_idx += 1
+        if part[0] == "obj":
+            objs += 1
+            stores.append(f"\tn = oz_logq_obj(rec, n, {arg});")
+            continue
+        enc = _log_arg_enc(part[2])
+        if enc == "str":
+            strs += 1
+            stores.append(f"\tn = oz_logq_str(rec, n, {arg});")
+        elif enc == "ptr":
+            fixed += 8
+            stores.append(f"\tn = oz_logq_u64(rec, n, "
+                          f"(uint64_t)(uintptr_t){arg});")
+        elif enc in ("i64", "u64"):
+            fixed += 8
+            stores.append(f"\tn = oz_logq_u64(rec, n, (uint64_t){arg});")
+        else:
+            fixed += 4
+            stores.append(f"\tn = oz_logq_u32(rec, n, (uint32_t){arg});")
+    if not stores:
+        return [f"\toz_logq_commit({msg_id}, NULL, 0);"]
+    size = [str(fixed)] if fixed else []
+    for count, macro in ((strs, "OZ_LOGQ_STR_BYTES"),
+                         (objs, "OZ_LOGQ_OBJ_BYTES")):
+        if count:
+            size.append(macro if count == 1 else f"{count} * {macro}")
+    return ([f"\tuint8_t rec[{' + '.join(size)}];", "\tint n = 0;", ""]
+            + stores + [f"\toz_logq_commit({msg_id}, rec, n);"])
+
+
+def _emit_log_call(node: dict, out: StringIO, ctx: _EmitCtx) -> bool:
+    """Lower OZLog("literal", ...) to a per-call-site writer.
+
+    With --log-specialize the writer copies literal segments with memcpy
+    and sends %@ arguments straight to cDescription:maxLength:, so the
+    format is never parsed at run time.  With --log-deferred it stores
+    the message ID and raw arguments in the binary log ring instead.
+    Returns False (emit the plain OZLog call) for non-literal formats,
+    unsupported specifiers or an argument count mismatch.
+    """
+    inner = node.get("inner", [])
+    if len(inner) < 2:
+        return False
+    callee = inner[0]
+    while callee.get("kind") == "ImplicitCastExpr" and callee.get("inner"):
+        callee = callee["inner"][0]
+    if (callee.get("kind") != "DeclRefExpr"
+            or callee.get("referencedDecl", {}).get("name") != "OZLog"):
+        return False
+    fmt = inner[1]
+    while fmt.get("kind") == "ImplicitCastExpr" and fmt.get("inner"):
+        fmt = fmt["inner"][0]
+    if fmt.get("kind") != "StringLiteral":
+        return False
+    fmt_bytes = _c_string_bytes(fmt.get("value", '""')[1:-1])
+    parts = _split_log_format(fmt_bytes)
+    args = inner[2:]
+    if parts is None or sum(p[0] != "lit" for p in parts) != len(args):
+        return False
+    offset = node.get("range", {}).get("begin", {}).get("offset")
+    if offset is None:
+        return False
+
+    name = f"_oz_log_{offset}"
+    params = []
+    for part in parts:
+        if part[0] == "lit":
+            continue
+        arg = f"a{len(params)}"
+        c_type = "const void *" if part[0] == "obj" else part[3]
+        params.append(f"{c_type}{arg}" if c_type.endswith("*")
+                      else f"{c_type} {arg}")
+    if _log_deferred:
+        body = _log_deferred_body(parts, _log_message_id(fmt_bytes, parts))
+    else:
+        body = _log_text_body(parts)
+    func = (f"static void {name}({', '.join(params) or 'void'})\n"
+            "{\n" + "\n".join(body) + "\n}")
+    header = f"static void {name}("
+    existing = [bf for bf in ctx.block_functions if bf.startswith(header)]
+    if existing and existing[0] != func:
+        return False
+    if not existing:
+        ctx.block_functions.append(func)
+
+    out.write(f"{name}(")
+    for i, arg in enumerate(args):
+        if i > 0:
+            out.write(", ")
+        _emit_expr(arg, out, ctx)
+    out.write(")")
+    return True
+
+
+def _oz_string_hash(data: bytes) -> int:
+    """FNV-1a matching -[OZString hash], with 0 reserved for 'not cached'."""
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h or 1
+
+
+def _dict_index_capacity(count: int) -> int:
+    """Mirror of OZDictionary_indexCapacity: power of two >= 2 * count."""
+    if count == 0:
+        return 0
+    cap = 1
+    while cap < count * 2:
+        cap <<= 1
+    return cap
+
+
+def _dict_index_words(count: int) -> int:
+    """Item-pool slots for a dictionary hash index (4-byte pointer bound)."""
+    return (_dict_index_capacity(count) * 2 + 3) // 4
+
+
+def _constant_key_hash(node: dict) -> int | None:
+    """Transpile-time -hash of a constant dictionary key, or None."""
+    while node.get("kind") in ("ImplicitCastExpr", "ParenExpr"):
+        node = node.get("inner", [{}])[0]
+    if node.get("kind") == "ObjCStringLiteral":
+        inner = node.get("inner", [])
+        val = inner[0].get("value", '""') if inner else '""'
+        return _oz_string_hash(_c_string_bytes(val[1:-1]))
+    const = _q31_constant(node)
+    if const is not None:
+        raw, shift = const
+        return ((raw * 2654435761) ^ shift) & 0xFFFFFFFF
+    return None
+
+
+def _constant_dict_index(hashes: list[int]) -> list[int]:
+    """Build a static open-addressed index (slot + 1, 0 empty).
+
+    Tries capacities up to 4x the minimum for a collision-free (perfect)
+    layout, else falls back to linear probing at the minimum capacity.
+    """
+    base = _dict_index_capacity(len(hashes))
+    for cap in (base, base * 2, base * 4):
+        if len({h & (cap - 1) for h in hashes}) == len(hashes):
+            break
+    else:
+        cap = base
+    table = [0] * cap
+    for i, h in enumerate(hashes):
+        slot = h & (cap - 1)
+        while table[slot]:
+            slot = (slot + 1) & (cap - 1)
+        table[slot] = i + 1
+    return table
+
+
+def _is_constant_literal(node: dict, module: OZModule) -> bool:
+    """Check if a literal can be emitted as a static immortal object.
+
+    True for string literals, foldable boxed numbers, and array/dictionary
+    literals whose elements are all (recursively) constant literals.
+    """
+    kind = node.get("kind", "")
+    if kind in ("ImplicitCastExpr", "ParenExpr"):
+        inner = node.get("inner", [])
+        return bool(inner) and _is_constant_literal(inner[0], module)
+    if kind == "ObjCStringLiteral":
+        return "OZString" in module.classes
+    if kind == "ObjCBoxedExpr":
+        return "OZQ31" in module.classes and _q31_constant(node) is not None
+    if kind == "ObjCArrayLiteral":
+        cls_name = "OZArray"
+    elif kind == "ObjCDictionaryLiteral":
+        cls_name = "OZDictionary"
+    else:
+        return False
+    return (cls_name in module.classes
+            and all(_is_constant_literal(c, module)
+                    for c in node.get("inner", [])))
+
+
+def _emit_constant_collection(node: dict, out: StringIO,
+                              ctx: _EmitCtx) -> None:
+    """Emit an immortal static OZArray/OZDictionary for a constant literal.
+
+    Elements are emitted first (their constants precede ours), then a
+    static const item table and the collection instance pointing at it.
+    """
+    root = ctx.root_class
+    refs = []
+    for child in node.get("inner", []):
+        buf = StringIO()
+        _emit_expr(child, buf, ctx)
+        refs.append(f"(struct {root} *){buf.getvalue()}")
+
+    is_array = node.get("kind") == "ObjCArrayLiteral"
+    if not is_array:
+        # AST order is k0, v0, k1, v1...; the table is keys then values
+        refs = refs[0::2] + refs[1::2]
+    cls_name = "OZArray" if is_array else "OZDictionary"
+    key = f"@{cls_name}:{', '.join(refs)}"
+    if key in ctx._string_dedup:
+        out.write(f"(struct {cls_name} *)&{ctx._string_dedup[key]}")
+        return
+
+    prefix = "_oz_arr" if is_array else "_oz_dict"
+    name = f"{prefix}_const{sum(k.startswith('@OZ') for k in ctx._string_dedup)}"
+    ctx._string_dedup[key] = name
+    header = (f".base = {{{{.class_id = OZ_CLASS_{cls_name}, "
+              f".immortal = 1}}, 1}}")
+    if refs:
+        ctx.string_constants.append(
+            f"static struct {root} *const {name}_items[] = {{"
+            + ", ".join(refs) + "};")
+        items = f"(struct {root} **){name}_items"
+    else:
+        items = f"(struct {root} **)0"
+    if is_array:
+        fields = f"._items = {items}, ._count = {len(refs)}"
+    else:
+        count = len(refs) // 2
+        values = f"{items} + {count}" if refs else items
+        fields = (f"._keys = {items}, ._values = {values}, "
+                  f"._count = {count}")
+        hashes = [_constant_key_hash(k) for k in node.get("inner", [])[0::2]]
+        if hashes and None not in hashes:
+            table = _constant_dict_index(hashes)
+            ctx.string_constants.append(
+                f"static const uint16_t {name}_index[] = {{"
+                + ", ".join(str(t) for t in table) + "};")
+            fields += (f", ._index = (uint16_t *){name}_index, "
+                       f"._mask = {len(table) - 1}")
+    ctx.string_constants.append(
+        f"static struct {cls_name} {name} = {{{header}, {fields}}};")
+    out.write(f"(struct {cls_name} *)&{name}")
+
+
 def _emit_boxed_number(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
-    """Emit a dynamically allocated OZQ31 via OZQ31_fixedWith*."""
+    """Emit an OZQ31 for @(...): immortal constant or OZQ31_fixedWith*."""
+    const = _q31_constant(node)
+    if const is not None and "OZQ31" in ctx.module.classes:
+        _emit_q31_constant(*const, out, ctx)
+        return
+
     inner = node.get("inner", [])
     if not inner:
         ctx.module.errors.append(
@@ -1969,7 +2968,7 @@ def _emit_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
         if val in ctx._string_dedup:
             name = ctx._string_dedup[val]
         else:
-            raw = val[1:-1]  # strip surrounding quotes
+            data = _c_string_bytes(val[1:-1])  # strip surrounding quotes
             loc = node.get("loc", {})
             line = loc.get("line")
             col = loc.get("col")
@@ -1983,7 +2982,7 @@ def _emit_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
             ctx.string_constants.append(
                 f"static struct OZString {name} = {{"
                 f"{{{{.class_id = OZ_CLASS_OZString, .immortal = 1}}, 1}}, "
-                f"{len(raw)}, 0, {val}}};"
+                f"{len(data)}, 0x{_oz_string_hash(data):08x}, {val}}};"
             )
         out.write(f"(struct OZString *)&{name}")
         return
@@ -2000,6 +2999,11 @@ def _emit_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
         _emit_boxed_number(node, out, ctx)
         return
 
+    if (kind in ("ObjCArrayLiteral", "ObjCDictionaryLiteral")
+            and _is_constant_literal(node, ctx.module)):
+        _emit_constant_collection(node, out, ctx)
+        return
+
     if kind == "ObjCArrayLiteral":
         inner = node.get("inner", [])
         buf_name = f"_oz_arr_{ctx._tmp_counter}_buf"
@@ -2093,6 +3097,8 @@ def _emit_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
         return
 
     if kind == "CallExpr":
+        if _log_specialize and _emit_log_call(node, out, ctx):
+            return
         inner = node.get("inner", [])
         if inner:
             _emit_expr(inner[0], out, ctx)
@@ -2250,7 +3256,12 @@ def _emit_msg_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
     if dispatch == DispatchKind.PROTOCOL:
         # Try compile-time dispatch when concrete receiver type is known
         concrete = _try_infer_concrete_class(receiver, module) if receiver else None
-        if concrete:
+        targets = (_devirt_targets(receiver, concrete, selector, module)
+                   if receiver else None)
+        if targets is not None:
+            _emit_devirt_call(node, receiver, args_exprs, targets,
+                              concrete, out, ctx)
+        elif concrete:
             # Compile-time dispatch: direct function call
             defining = _find_defining_class(concrete, selector, module)
             ret_qt = node.get("type", {}).get("qualType", "void")
@@ -2289,6 +3300,9 @@ def _emit_msg_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
                     f"struct {root_class} *{tmp} = "
                     f"(struct {root_class} *){recv_str};\n"
                 )
+                if selector in _dispatch_guards:
+                    _emit_guarded_send(node, tmp, args_exprs, out, ctx)
+                    return
                 out.write(f"OZ_PROTOCOL_SEND_{c_sel}({tmp}")
             else:
                 out.write(f"OZ_PROTOCOL_SEND_{c_sel}(")
@@ -2318,6 +3332,146 @@ def _emit_msg_expr(node: dict, out: StringIO, ctx: _EmitCtx) -> None:
         out.write(")")
 
 
+def _devirt_targets(receiver: dict, concrete: str | None, selector: str,
+                    module: OZModule) -> list[tuple[str, list[str]]] | None:
+    """Class-hierarchy + rapid-type analysis for a polymorphic send.
+
+    Returns the reachable implementations as ``(impl_class, [class, ...])``
+    pairs, or None when the send must keep its existing lowering:
+    devirtualization is off, the receiver is a fresh ``[Cls alloc]``
+    (already exact), no instantiated class can receive it, or more than
+    _DEVIRT_MAX_TARGETS implementations are reachable from an ``id``.
+    """
+    if _instantiated_classes is None:
+        return None
+    unwrapped = receiver
+    while unwrapped.get("kind") in ("ImplicitCastExpr", "ParenExpr"):
+        inner = unwrapped.get("inner", [])
+        if not inner:
+            break
+        unwrapped = inner[0]
+    if (unwrapped.get("kind") == "ObjCMessageExpr"
+            and unwrapped.get("selector") in _ALLOC_SELECTORS):
+        return None
+
+    impls: dict[str, list[str]] = {}
+    for name in sorted(_instantiated_classes,
+                       key=lambda n: module.classes[n].class_id):
+        if concrete and name != concrete and not _is_subclass(
+                name, concrete, module):
+            continue
+        impl_cls = _find_implementing_class(module.classes[name],
+                                            selector, module)
+        if impl_cls:
+            impls.setdefault(impl_cls.name, []).append(name)
+    if not impls:
+        return None
+    if len(impls) > _DEVIRT_MAX_TARGETS:
+        # Class-typed receivers stay sound via the vtable; id keeps it too
+        return [] if concrete else None
+    return list(impls.items())
+
+
+def _emit_devirt_call(node: dict, receiver: dict, args_exprs: list[dict],
+                      targets: list[tuple[str, list[str]]],
+                      concrete: str | None, out: StringIO,
+                      ctx: _EmitCtx) -> None:
+    """Emit a devirtualized send: direct call, class_id compare chain,
+    or (empty targets) the const vtable fallback."""
+    root_class = ctx.root_class
+    c_sel = _selector_to_c(node.get("selector", ""))
+    ret_oz = OZType(node.get("type", {}).get("qualType", "void"))
+    ret_c = ret_oz.c_type
+
+    arg_strs = []
+    for arg in args_exprs:
+        buf = StringIO()
+        _emit_expr(arg, buf, ctx)
+        arg_strs.append(buf.getvalue())
+    args_tail = "".join(f", {a}" for a in arg_strs)
+
+    def call(impl: str, recv: str, needs_cast: bool) -> str:
+        cast = (f"({ret_c})" if ret_oz.is_object
+                and ret_c != f"struct {impl} *" else "")
+        recv_cast = f"(struct {impl} *)" if needs_cast else ""
+        return f"{cast}{impl}_{c_sel}({recv_cast}{recv}{args_tail})"
+
+    recv_buf = StringIO()
+    _emit_expr(receiver, recv_buf, ctx)
+    recv_str = recv_buf.getvalue()
+
+    # Single reachable implementation: direct call, no temp needed
+    if len(targets) == 1:
+        impl = targets[0][0]
+        out.write(call(impl, recv_str, impl != concrete))
+        return
+
+    # Receiver goes into a temp to avoid double evaluation
+    tmp = f"_oz_recv{ctx._tmp_counter}"
+    ctx._tmp_counter += 1
+    ctx.pre_stmts.append(
+        f"struct {root_class} *{tmp} = "
+        f"(struct {root_class} *){recv_str};\n"
+    )
+    if not targets:
+        if ret_oz.is_object and ret_c != f"struct {root_class} *":
+            out.write(f"({ret_c})")
+        if node.get("selector", "") in _dispatch_guards:
+            out.write(_guarded_send_str(node, tmp, arg_strs, ctx))
+        else:
+            out.write(f"OZ_PROTOCOL_SEND_{c_sel}({tmp}{args_tail})")
+        return
+
+    # Two or three implementations: inline class_id compare chain,
+    # the last implementation is the fall-through arm
+    out.write("(")
+    for impl, names in targets[:-1]:
+        cond = " || ".join(f"{tmp}->_meta.class_id == OZ_CLASS_{n}"
+                           for n in names)
+        if len(names) > 1:
+            cond = f"({cond})"
+        out.write(f"{cond} ? {call(impl, tmp, True)} : ")
+    out.write(f"{call(targets[-1][0], tmp, True)})")
+
+
+def _guarded_send_str(node: dict, tmp: str, arg_strs: list[str],
+                      ctx: _EmitCtx) -> str:
+    """Inline-cache guard for a profiled polymorphic send.
+
+    ``(tmp->_meta.class_id == OZ_CLASS_X ? Impl_sel(...) : OZ_PROTOCOL_SEND_sel(...))``
+    where X is the dominant receiver class from the dispatch profile and
+    Impl is the class X inherits the selector from.  The caller has already
+    written any return cast.
+    """
+    root_class = ctx.root_class
+    selector = node.get("selector", "")
+    c_sel = _selector_to_c(selector)
+    guard_cls = _dispatch_guards[selector]
+    impl_cls = _find_implementing_class(ctx.module.classes[guard_cls],
+                                        selector, ctx.module)
+    args_tail = "".join(f", {a}" for a in arg_strs)
+    send = f"OZ_PROTOCOL_SEND_{c_sel}({tmp}{args_tail})"
+    if impl_cls is None:
+        return send
+    # Both arms share one pointer type so the conditional is well-typed
+    ret_oz = OZType(node.get("type", {}).get("qualType", "void"))
+    cast = (f"(struct {root_class} *)" if ret_oz.is_object else "")
+    return (f"({tmp}->_meta.class_id == OZ_CLASS_{guard_cls} ? "
+            f"{cast}{impl_cls.name}_{c_sel}((struct {impl_cls.name} *){tmp}"
+            f"{args_tail}) : {cast}{send})")
+
+
+def _emit_guarded_send(node: dict, tmp: str, args_exprs: list[dict],
+                       out: StringIO, ctx: _EmitCtx) -> None:
+    """Emit a guarded send for the vtable fallback path."""
+    arg_strs = []
+    for arg in args_exprs:
+        buf = StringIO()
+        _emit_expr(arg, buf, ctx)
+        arg_strs.append(buf.getvalue())
+    out.write(_guarded_send_str(node, tmp, arg_strs, ctx))
+
+
 _ROOT_INTROSPECTION_SELS = {"isEqual:", "cDescription:maxLength:",
                             "retain", "release", "retainCount"}
 
@@ -2436,8 +3590,7 @@ def _emit_break_continue_releases(out: StringIO, ctx: _EmitCtx,
         frame = ctx.scope_vars[i]
         for name in frame:
             if name not in ctx.consumed_vars:
-                out.write(f"{tabs}{ctx.root_class}_release("
-                          f"(struct {ctx.root_class} *){name});\n")
+                out.write(f"{tabs}{_scope_release(name, ctx)}\n")
 
 
 def _emit_scope_releases(out: StringIO, ctx: _EmitCtx, indent: int) -> None:
@@ -2448,8 +3601,17 @@ def _emit_scope_releases(out: StringIO, ctx: _EmitCtx, indent: int) -> None:
     frame = ctx.scope_vars[-1]
     for name in frame:
         if name not in ctx.consumed_vars:
-            out.write(f"{tabs}{ctx.root_class}_release("
-                      f"(struct {ctx.root_class} *){name});\n")
+            out.write(f"{tabs}{_scope_release(name, ctx)}\n")
+
+
+def _scope_release(name: str, ctx: _EmitCtx) -> str:
+    """Release statement for a scope var; @synchronized guards unlock."""
+    for frame in reversed(ctx.scope_vars):
+        if name in frame:
+            if frame[name].raw_qual_type == _SYNC_GUARD_TYPE:
+                return f"oz_sync_exit({name});"
+            break
+    return f"{ctx.root_class}_release((struct {ctx.root_class} *){name});"
 
 
 def _emit_return_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
@@ -2466,8 +3628,7 @@ def _emit_return_stmt(node: dict, out: StringIO, ctx: _EmitCtx,
     for name in all_vars:
         if name == returned_var or name in ctx.consumed_vars:
             continue
-        out.write(f"{tabs}{ctx.root_class}_release("
-                  f"(struct {ctx.root_class} *){name});\n")
+        out.write(f"{tabs}{_scope_release(name, ctx)}\n")
 
     if inner:
         ret_expr = inner[0]
@@ -2513,9 +3674,12 @@ def _find_returned_var(node: dict) -> str | None:
 
 
 def _flatten_scope_vars(ctx: _EmitCtx) -> list[str]:
-    """Collect all object var names from all scope frames."""
+    """Collect all object var names from all scope frames, innermost first.
+
+    Innermost-first keeps nested @synchronized guards exiting in LIFO order.
+    """
     result = []
-    for frame in ctx.scope_vars:
+    for frame in reversed(ctx.scope_vars):
         for name in frame:
             result.append(name)
     return result
@@ -2799,7 +3963,7 @@ def _emit_collection_dealloc_array(cls: OZClass, root_class: str,
 
 def _emit_collection_dealloc_dict(cls: OZClass, root_class: str,
                                   is_root: bool, out: StringIO) -> None:
-    """Emit dealloc for OZDictionary: release keys+values, free contiguous buffer."""
+    """Emit dealloc for OZDictionary: release keys+values, free buffer and index."""
     out.write(f"void {cls.name}_dealloc(struct {cls.name} *self)\n")
     out.write("{\n")
     out.write(f"\tfor (unsigned int i = 0; i < self->_count; i++) {{\n")
@@ -2808,7 +3972,8 @@ def _emit_collection_dealloc_dict(cls: OZClass, root_class: str,
     out.write(f"\t}}\n")
     out.write(f"\tif (self->_keys) {{\n")
     out.write(f"\t\toz_mem_blocks_free_contiguous(&oz_item_pool,\n")
-    out.write(f"\t\t\tself->_keys, self->_count * 2);\n")
+    out.write(f"\t\t\tself->_keys, self->_count * 2 +\n")
+    out.write(f"\t\t\t{cls.name}_indexWords(self->_count));\n")
     out.write(f"\t}}\n")
     if not is_root:
         out.write(f"\t{cls.superclass}_dealloc((struct {cls.superclass} *)self);\n")
@@ -2964,17 +4129,154 @@ def _is_borrowed_object_expr(node: dict) -> bool:
     return False
 
 
+
+# ---------------------------------------------------------------------------
+# ARC optimisation (--arc-optimize)
+# ---------------------------------------------------------------------------
+
+# Calls that can never drop a reference count to zero.
+_ARC_SAFE_CALLS = frozenset({
+    "sizeof", "oz_isKindOfClass", "oz_isMemberOfClass", "oz_conformsTo",
+})
+
+_ARC_LITERAL_RE = re.compile(r'"(?:\\.|[^"\\])*"|\'(?:\\.|[^\'\\])*\'')
+_ARC_CALL_RE = re.compile(r"\b([A-Za-z_]\w*)\s*\(")
+_ARC_CONTROL_RE = re.compile(
+    r"[{}]|^\s*#|^\s*[A-Za-z_]\w*\s*:(?!:)|\b(?:return|break|continue|goto"
+    r"|case|default|if|else|for|while|do|switch)\b")
+
+
+def _arc_optimize_body(text: str, root: str) -> tuple[str, int]:
+    """Remove redundant retain/release pairs from one emitted function body.
+
+    Works on the straight-line statement runs of the emitted C, in the
+    spirit of LLVM's ObjCARCOpts:
+
+    - ``retain(x) ... release(x)`` is dropped when nothing in between can
+      release an object (no calls other than retains, no releases).
+    - ``retain(x) ... retain(x) ... release(x)`` drops the inner pair: the
+      outer retain keeps ``x`` alive, so its +1 is forwarded to whatever
+      consumed the inner one (e.g. a parameter stored into a strong ivar).
+      Not when ``x`` is copied into another variable that is released
+      before the inner release: that release may be spending the +1 this
+      rule would remove.
+
+    A run ends at any brace, jump, label or reassignment of ``x``.
+    Returns the optimised text and the number of pairs eliminated.
+    """
+    retain_re = re.compile(
+        rf"^\s*{root}_retain\(\(struct {root} \*\)(\w+)\);$")
+    release_re = re.compile(
+        rf"^\s*{root}_release\(\(struct {root} \*\)(\w+)\);$")
+    any_release_re = re.compile(
+        rf"^\s*{root}_release\(\(struct {root} \*\)(.+)\);$")
+    assign_re = re.compile(r"^\s*([\w.>-]+?)\s*=(?!=)\s*(.+);$")
+    safe_calls = _ARC_SAFE_CALLS | {f"{root}_retain"}
+    lines = text.split("\n")
+    code = [_ARC_LITERAL_RE.sub('""', line) for line in lines]
+    dead: set[int] = set()
+
+    def _ends_run(i: int, name: str) -> bool:
+        line = code[i]
+        return bool(_ARC_CONTROL_RE.search(line)
+                     or re.search(rf"(?<![\w.>]){name}\s*=(?!=)", line)
+                     or re.search(rf"&\s*{name}\b", line))
+
+    def _may_release(i: int) -> bool:
+        return any(c not in safe_calls
+                   for c in _ARC_CALL_RE.findall(code[i]))
+
+    def _is_op(regex: re.Pattern, i: int, name: str) -> bool:
+        m = regex.match(lines[i])
+        return bool(m) and m.group(1) == name
+
+    def _find_release(start: int, name: str) -> int | None:
+        """Matching release of an inner retain, or None if unsafe to pair."""
+        aliases = {name}
+        for j in range(start, len(lines)):
+            if j in dead:
+                continue
+            if _is_op(release_re, j, name):
+                return j
+            if _ends_run(j, name):
+                return None
+            m = any_release_re.match(lines[j])
+            if m and m.group(1).strip() in aliases:
+                return None
+            m = assign_re.match(code[j])
+            if m and any(re.search(rf"(?<![\w.>]){re.escape(a)}\b", m.group(2))
+                         for a in aliases):
+                aliases.add(m.group(1))
+        return None
+
+    count = 0
+    changed = True
+    while changed:
+        changed = False
+        for i, line in enumerate(lines):
+            if i in dead:
+                continue
+            m = retain_re.match(line)
+            if not m:
+                continue
+            name = m.group(1)
+            quiet = True
+            for j in range(i + 1, len(lines)):
+                if j in dead:
+                    continue
+                if _is_op(release_re, j, name):
+                    if quiet:
+                        dead.update((i, j))
+                        count += 1
+                        changed = True
+                    break
+                if _is_op(retain_re, j, name):
+                    k = _find_release(j + 1, name)
+                    if k is not None:
+                        dead.update((j, k))
+                        count += 1
+                        changed = True
+                    break
+                if _ends_run(j, name):
+                    break
+                if _may_release(j):
+                    quiet = False
+            if changed:
+                break
+
+    kept = [line for i, line in enumerate(lines) if i not in dead]
+    return "\n".join(kept), count
+
+
+def _write_arc_optimized(body: str, out: StringIO, ctx: _EmitCtx) -> None:
+    """Write an ARC-optimised function body and record its elision count."""
+    optimized, count = _arc_optimize_body(body, ctx.root_class)
+    proto = out.getvalue().rstrip("\n").rsplit("\n", 1)[-1]
+    out.write(optimized)
+    if count:
+        m = re.search(r"(\w+)\s*\(", proto)
+        fn = m.group(1) if m else ctx.cls.name
+        plural = "" if count == 1 else "s"
+        ctx.module.notes.append(
+            f"arc: {fn}: eliminated {count} retain/release pair{plural}")
+
 def _count_item_slots(module: OZModule) -> int:
-    """Count total id-slots needed for dynamic array/dict literals."""
+    """Count total id-slots needed for dynamic array/dict literals.
+
+    Constant literals use static item tables and need no slots.
+    """
     total = 0
 
     def walk(node: dict) -> None:
         nonlocal total
         kind = node.get("kind", "")
+        if _is_constant_literal(node, module):
+            return
         if kind == "ObjCArrayLiteral":
             total += len(node.get("inner", []))
         elif kind == "ObjCDictionaryLiteral":
-            total += len(node.get("inner", []))  # keys + values
+            count = len(node.get("inner", []))
+            total += count + _dict_index_words(count // 2)  # keys + values
         for child in node.get("inner", []):
             walk(child)
 
@@ -2996,12 +4298,41 @@ def _count_item_slots(module: OZModule) -> int:
     return total
 
 
+# OZMutableString buffer size classes: powers of two from 32 bytes up to
+# --mstring-max-size.  Default blocks per class; larger classes get one.
+# Contents up to 23 characters stay inline in the object.
+_MSTRING_POOL_DEFAULTS = {32: 4, 64: 4, 128: 2}
+
+
+def _mstring_pools(module: OZModule, pool_sizes: dict[str, int],
+                   max_size: int = 256) -> list[dict]:
+    """Size-classed buffer slabs for OZMutableString growth.
+
+    Emitted only when OZMutableString is part of the module.  Classes
+    double from 32 bytes until they reach max_size (rounded up to a power
+    of two); without an OZHeap, contents of max_size characters or more
+    cannot be stored.  Each class is sized by a "OZMutableString.<bytes>" entry
+    in --pool-sizes or the pool profile, falling back to
+    _MSTRING_POOL_DEFAULTS.
+    """
+    if "OZMutableString" not in module.classes:
+        return []
+    sizes = [32]
+    while sizes[-1] < max_size:
+        sizes.append(sizes[-1] * 2)
+    return [{"size": size,
+             "count": pool_sizes.get(f"OZMutableString.{size}",
+                                     _MSTRING_POOL_DEFAULTS.get(size, 1))}
+            for size in sizes]
+
+
 def _count_alloc_calls(module: OZModule) -> dict[str, int]:
     """Count allocations across all method/function body ASTs.
 
     Counts explicit [ClassName alloc] calls plus implicit allocations
-    from literal expressions (@42 → OZQ31, @[...] → OZArray,
-    @{...} → OZDictionary).
+    from literal expressions (@(expr) → OZQ31, @[...] → OZArray,
+    @{...} → OZDictionary).  Constant literals (@42, and collections of
+    constants) are static immortal objects and take no slab block.
     """
     counts: dict[str, int] = {}
 
@@ -3013,14 +4344,14 @@ def _count_alloc_calls(module: OZModule) -> dict[str, int]:
             class_name = node.get("classType", {}).get("qualType", "")
             if class_name:
                 counts[class_name] = counts.get(class_name, 0) + 1
+        elif _is_constant_literal(node, module):
+            return
         elif kind == "ObjCArrayLiteral":
             counts["OZArray"] = counts.get("OZArray", 0) + 1
         elif kind == "ObjCDictionaryLiteral":
             counts["OZDictionary"] = counts.get("OZDictionary", 0) + 1
         elif kind == "ObjCBoxedExpr":
             counts["OZQ31"] = counts.get("OZQ31", 0) + 1
-        elif kind == "ObjCAtSynchronizedStmt":
-            counts["OZSpinLock"] = counts.get("OZSpinLock", 0) + 1
         for child in node.get("inner", []):
             walk(child)
 
@@ -3042,6 +4373,78 @@ def _count_alloc_calls(module: OZModule) -> dict[str, int]:
     return counts
 
 
+def _uses_synchronized(module: OZModule) -> bool:
+    """Check whether any body contains @synchronized (needs the lock table)."""
+    def walk(node: dict) -> bool:
+        if node.get("kind") == "ObjCAtSynchronizedStmt":
+            return True
+        return any(walk(child) for child in node.get("inner", []))
+
+    bodies = []
+    for cls in module.classes.values():
+        bodies += [m.body_ast for m in cls.methods]
+        bodies += [f.body_ast for f in cls.functions]
+    bodies += [f.body_ast for f in module.functions]
+    for orphan in module.orphan_sources:
+        bodies += [f.body_ast for f in orphan.functions]
+    return any(walk(b) for b in bodies if b)
+
+
+_ALLOC_SELECTORS = frozenset({"alloc", "allocWithHeap:", "new"})
+
+
+def _find_instantiated_classes(module: OZModule) -> set[str] | None:
+    """Collect every class that can have live instances (RTA roots).
+
+    Starts from the allocation counts (explicit alloc, collection/number
+    literals) and adds +allocWithHeap:, +new and string
+    literals.  Returns None when an allocation is sent to a non-class
+    receiver (e.g. [[self class] alloc]), since the set is then unknown.
+    """
+    found = {name for name in _count_alloc_calls(module)
+             if name in module.classes}
+    dynamic = False
+
+    def walk(node: dict) -> None:
+        nonlocal dynamic
+        kind = node.get("kind", "")
+        if (kind == "ObjCMessageExpr"
+                and node.get("selector") in _ALLOC_SELECTORS):
+            class_name = node.get("classType", {}).get("qualType", "")
+            if node.get("receiverKind") != "class":
+                dynamic = True
+            elif class_name in module.classes:
+                found.add(class_name)
+        elif kind == "ObjCStringLiteral" and "OZString" in module.classes:
+            found.add("OZString")
+        elif kind == "ObjCBoxedExpr" and "OZQ31" in module.classes:
+            found.add("OZQ31")
+        elif kind == "ObjCArrayLiteral" and "OZArray" in module.classes:
+            found.add("OZArray")
+        elif (kind == "ObjCDictionaryLiteral"
+              and "OZDictionary" in module.classes):
+            found.add("OZDictionary")
+        for child in node.get("inner", []):
+            walk(child)
+
+    for cls in module.classes.values():
+        for m in cls.methods:
+            if m.body_ast:
+                walk(m.body_ast)
+        for func in cls.functions:
+            if func.body_ast:
+                walk(func.body_ast)
+    for func in module.functions:
+        if func.body_ast:
+            walk(func.body_ast)
+    for orphan in module.orphan_sources:
+        for func in orphan.functions:
+            if func.body_ast:
+                walk(func.body_ast)
+
+    return None if dynamic else found
+
+
 def _selector_to_c(selector: str) -> str:
     """Convert an ObjC selector to a C-safe identifier.
 
@@ -3515,5 +4918,16 @@ def _emit_patched_orphan_source(orphan: OrphanSource, module: OZModule,
 
 
 def _write_file(path: str, content: str) -> None:
+    """Write content unless the file already holds exactly that.
+
+    Leaving unchanged outputs untouched keeps their mtime, so the C
+    compile of a class whose generated code did not change is skipped.
+    """
+    try:
+        with open(path) as f:
+            if f.read() == content:
+                return
+    except OSError:
+        pass
     with open(path, "w") as f:
         f.write(content)
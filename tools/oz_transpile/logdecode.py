@@ -0,0 +1,228 @@
+# SPDX-License-Identifier: Apache-2.0
+#
+# logdecode.py - Rebuild deferred OZLog (--log-deferred) text off-target.
+#
+# Usage:
+#   python3 -m oz_transpile.logdecode build/oz_generated/Foundation/oz_log_dict.json \
+#       oz_log.bin
+#   python3 -m oz_transpile.logdecode oz_log_dict.json --hex shell_capture.txt
+#
+# The binary input is what oz_log_drain() produced (host builds append it
+# to $OZ_LOG_OUT at exit); --hex accepts the `oz_log` shell command output.
+
+from __future__ import annotations
+
+import argparse
+import json
+import re
+import struct
+import sys
+from pathlib import Path
+
+_LENGTH_RE = re.compile(r"(hh|h|ll|l|L|q|j|z|t)(?=[a-zA-Z]$)")
+
+_HEX_LINE_RE = re.compile(r"(?:[0-9a-fA-F]{2})+")
+
+_FIXED = {"i32": "<i", "u32": "<I", "i64": "<q", "u64": "<Q", "ptr": "<Q"}
+
+
+class LogDecodeError(Exception):
+    pass
+
+
+def q31_to_str(raw: int, shift: int, precision: int = 14) -> str:
+    """Port of _oz_q31_to_str (src/OZQ31.m): fixed-point Q31 to decimal."""
+    precision = max(0, min(precision, 14))
+    if raw == 0:
+        return "0"
+    neg = raw < 0
+    abs_raw = -raw if neg else raw
+    frac_bits = 0 if shift >= 31 else 31 - shift
+    int_part = abs_raw >> frac_bits
+    frac = abs_raw & ((1 << frac_bits) - 1)
+
+    digits = [0] * 15
+    if frac_bits > 0:
+        for i in range(min(precision + 1, 15)):
+            frac *= 10
+            digits[i] = frac >> frac_bits
+            frac &= (1 << frac_bits) - 1
+
+    if precision > 0 and digits[precision] >= 5:
+        carry = 1
+        for i in range(precision - 1, -1, -1):
+            if not carry:
+                break
+            if digits[i] + carry >= 10:
+                digits[i] = 0
+            else:
+                digits[i] += carry
+                carry = 0
+        if carry:
+            int_part += 1
+
+    last = -1
+    for i in range(precision - 1, -1, -1):
+        if digits[i]:
+            last = i
+            break
+    text = ("-" if neg else "") + str(int_part)
+    if last >= 0:
+        text += "." + "".join(str(d) for d in digits[:last + 1])
+    return text
+
+
+class LogDict:
+    """Message and class tables from oz_log_dict.json."""
+
+    def __init__(self, data: dict):
+        if data.get("version") != 1:
+            raise LogDecodeError(
+                f"unsupported dictionary version {data.get('version')}")
+        self.messages = {m["id"]: m for m in data["messages"]}
+        self.classes = {c["id"]: c for c in data["classes"]}
+        self._by_name = {c["name"]: c for c in data["classes"]}
+
+    @classmethod
+    def load(cls, path: str | Path) -> LogDict:
+        return cls(json.loads(Path(path).read_text()))
+
+    def is_kind_of(self, class_id: int, name: str) -> bool:
+        cls = self.classes.get(class_id)
+        while cls is not None:
+            if cls["name"] == name:
+                return True
+            cls = self._by_name.get(cls["super"])
+        return False
+
+    def format_object(self, class_id: int, payload: bytes,
+                      precision: int) -> str:
+        if class_id == 0xFFFF:
+            return "(nil)"
+        if class_id not in self.classes:
+            return f"<class {class_id}>"
+        if self.is_kind_of(class_id, "OZString"):
+            return payload.decode("utf-8", errors="replace")
+        if self.is_kind_of(class_id, "OZQ31") and len(payload) == 5:
+            raw, shift = struct.unpack("<iB", payload)
+            return q31_to_str(raw, shift, precision if precision >= 0 else 14)
+        return f"<{self.classes[class_id]['name']}>"
+
+
+def _format_arg(spec: str, value) -> str:
+    conv = spec[-1]
+    spec = _LENGTH_RE.sub("", spec)
+    if conv == "p":
+        return "0x%x" % value
+    if conv == "c":
+        value &= 0xFF
+    if conv == "s" and value is None:
+        value = "(null)"
+    return spec % value
+
+
+def decode_record(log_dict: LogDict, msg_id: int, payload: bytes) -> str:
+    """Rebuild the text of one record."""
+    msg = log_dict.messages.get(msg_id)
+    if msg is None:
+        raise LogDecodeError(f"unknown message id {msg_id}")
+    out = []
+    pos = 0
+    try:
+        for part in msg["parts"]:
+            if part[0] == "lit":
+                out.append(part[1])
+            elif part[0] == "obj":
+                class_id, length = struct.unpack_from("<HB", payload, pos)
+                pos += 3
+                out.append(log_dict.format_object(
+                    class_id, payload[pos:pos + length], part[1]))
+                pos += length
+            elif part[2] == "str":
+                length = payload[pos]
+                pos += 1
+                if length == 0xFF:
+                    out.append(_format_arg(part[1], None))
+                    continue
+                text = payload[pos:pos + length].decode("utf-8",
+                                                        errors="replace")
+                out.append(_format_arg(part[1], text))
+                pos += length
+            else:
+                fmt = _FIXED[part[2]]
+                (value,) = struct.unpack_from(fmt, payload, pos)
+                pos += struct.calcsize(fmt)
+                out.append(_format_arg(part[1], value))
+    except (struct.error, IndexError):
+        raise LogDecodeError(f"truncated record for message {msg_id}")
+    return "".join(out)
+
+
+def iter_records(data: bytes):
+    """Yield (id, payload) for each <id u16><len u16><payload> record."""
+    pos = 0
+    while pos + 4 <= len(data):
+        msg_id, length = struct.unpack_from("<HH", data, pos)
+        payload = data[pos + 4:pos + 4 + length]
+        if len(payload) < length:
+            raise LogDecodeError(f"truncated record at offset {pos}")
+        yield msg_id, payload
+        pos += 4 + (length + 3) // 4 * 4
+
+
+def parse_hex(text: str) -> tuple[bytes, int]:
+    """Join `oz_log` shell output into bytes; returns (data, dropped).
+
+    Lines that are not hex dumps (prompts, other console output) are
+    skipped.
+    """
+    data = bytearray()
+    dropped = 0
+    for line in text.splitlines():
+        line = line.strip()
+        if line.startswith("# dropped"):
+            dropped += int(line.split()[2])
+        elif _HEX_LINE_RE.fullmatch(line):
+            data += bytes.fromhex(line)
+    return bytes(data), dropped
+
+
+def decode(log_dict: LogDict, data: bytes) -> list[str]:
+    return [decode_record(log_dict, msg_id, payload)
+            for msg_id, payload in iter_records(data)]
+
+
+def main(argv: list[str] | None = None) -> int:
+    p = argparse.ArgumentParser(
+        prog="oz_transpile.logdecode",
+        description="Decode a deferred OZLog capture into text",
+    )
+    p.add_argument("dictionary", help="Foundation/oz_log_dict.json")
+    p.add_argument("log", nargs="?", default="-",
+                   help="Drained log (default: stdin)")
+    p.add_argument("--hex", action="store_true",
+                   help="Input is `oz_log` shell output (hex lines)")
+    args = p.parse_args(argv)
+
+    try:
+        log_dict = LogDict.load(args.dictionary)
+        if args.log == "-":
+            raw = sys.stdin.buffer.read()
+        else:
+            raw = Path(args.log).read_bytes()
+        dropped = 0
+        if args.hex:
+            raw, dropped = parse_hex(raw.decode("ascii", errors="replace"))
+        # OZLog() ends every message with a newline; records do not store it
+        for text in decode(log_dict, raw):
+            sys.stdout.write(text + "\n")
+    except (OSError, ValueError, LogDecodeError) as e:
+        print(f"error: {e}", file=sys.stderr)
+        return 1
+    if dropped:
+        print(f"# {dropped} record(s) dropped on target", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
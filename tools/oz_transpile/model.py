@@ -266,6 +266,7 @@ class OZMethod:
 class OZProtocol:
     name: str
     methods: list[OZMethod] = field(default_factory=list)
+    protocols: list[str] = field(default_factory=list)
 
 
 @dataclass(slots=True)
@@ -326,6 +327,7 @@ class OZModule:
     type_defs: dict[str, str] = field(default_factory=dict)
     diagnostics: list[str] = field(default_factory=list)
     errors: list[str] = field(default_factory=list)
+    notes: list[str] = field(default_factory=list)
     initialize_classes: list[str] = field(default_factory=list)
     generic_types: dict[str, str] = field(default_factory=dict)
     source_stem: str = ""
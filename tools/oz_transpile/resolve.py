@@ -97,25 +97,28 @@ def _check_duplicate_methods(module: OZModule) -> None:
 
 
 def _assign_class_ids(module: OZModule) -> None:
-    """Assign class_id in topological order (root=0)."""
-    assigned: dict[str, int] = {}
-    next_id = 0
-
-    def assign(name: str) -> int:
-        nonlocal next_id
-        if name in assigned:
-            return assigned[name]
-        cls = module.classes.get(name)
-        if cls and cls.superclass and cls.superclass in module.classes:
-            assign(cls.superclass)
-        assigned[name] = next_id
-        if cls:
-            cls.class_id = next_id
-        next_id += 1
-        return assigned[name]
+    """Assign class_id in DFS preorder (root=0, siblings by name).
 
+    Preorder keeps every subtree contiguous: a class and all of its
+    subclasses occupy [class_id, subtree_end), which lets
+    oz_isKindOfClass() be a range check instead of a superclass walk.
+    """
+    children: dict[str, list[str]] = {}
+    roots = []
     for name in sorted(module.classes):
-        assign(name)
+        sup = module.classes[name].superclass
+        if sup and sup in module.classes:
+            children.setdefault(sup, []).append(name)
+        else:
+            roots.append(name)
+
+    next_id = 0
+    stack = list(reversed(roots))
+    while stack:
+        name = stack.pop()
+        module.classes[name].class_id = next_id
+        next_id += 1
+        stack.extend(reversed(children.get(name, [])))
 
 
 def _compute_base_depths(module: OZModule) -> None:
@@ -158,7 +161,8 @@ def _classify_dispatch(module: OZModule) -> None:
             selector_classes[m.selector].add(cls.name)
 
     # Selectors that must always be protocol-dispatched (called polymorphically)
-    always_protocol = {"dealloc", "init", "isEqual:", "cDescription:maxLength:"}
+    always_protocol = {"dealloc", "init", "isEqual:", "cDescription:maxLength:",
+                       "encode:maxLength:"}
 
     for cls in module.classes.values():
         for m in cls.methods:
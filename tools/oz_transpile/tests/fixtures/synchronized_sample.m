@@ -1,4 +1,4 @@
-/* @synchronized sample - tests OZSpinLock RAII transpilation */
+/* @synchronized sample - tests striped lock guard transpilation */
 
 #import <objc/objc.h>
 
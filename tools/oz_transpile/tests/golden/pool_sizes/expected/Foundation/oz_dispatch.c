@@ -8,11 +8,20 @@ const char *const oz_class_names[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_OZLed] = "OZLed",
 };
 
+const uint32_t oz_class_protocols[OZ_CLASS_COUNT][OZ_PROTO_WORDS] = {
+	[OZ_CLASS_OZLed] = { 0x00000001u }, /* OZToggleable */
+};
+
 const uint8_t oz_superclass_id[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_OZObject] = OZ_CLASS_COUNT,
 	[OZ_CLASS_OZLed] = OZ_CLASS_OZObject,
 };
 
+const uint8_t oz_class_subtree_end[OZ_CLASS_COUNT] = {
+	[OZ_CLASS_OZObject] = 2,
+	[OZ_CLASS_OZLed] = 2,
+};
+
 const OZ_fn_init OZ_PROTOCOL_RESOLVE_init[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_OZLed] = (OZ_fn_init)OZLed_init,
 };
@@ -21,10 +30,6 @@ const OZ_fn_toggle OZ_PROTOCOL_RESOLVE_toggle[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_OZLed] = (OZ_fn_toggle)OZLed_toggle,
 };
 
-/* Weak default: returns -1 (no precision override).
- * OZLog.c provides the strong definition on Zephyr. */
-__attribute__((weak)) int _oz_get_log_precision(void) { return -1; }
-
 void OZObject_dispatch_free(struct OZObject *obj)
 {
 	switch (obj->_meta.class_id) {
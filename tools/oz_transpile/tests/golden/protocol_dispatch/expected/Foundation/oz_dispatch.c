@@ -10,12 +10,23 @@ const char *const oz_class_names[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_Square] = "Square",
 };
 
+const uint32_t oz_class_protocols[OZ_CLASS_COUNT][OZ_PROTO_WORDS] = {
+	[OZ_CLASS_Circle] = { 0x00000001u }, /* Drawable */
+	[OZ_CLASS_Square] = { 0x00000001u }, /* Drawable */
+};
+
 const uint8_t oz_superclass_id[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_OZObject] = OZ_CLASS_COUNT,
 	[OZ_CLASS_Circle] = OZ_CLASS_OZObject,
 	[OZ_CLASS_Square] = OZ_CLASS_OZObject,
 };
 
+const uint8_t oz_class_subtree_end[OZ_CLASS_COUNT] = {
+	[OZ_CLASS_OZObject] = 3,
+	[OZ_CLASS_Circle] = 2,
+	[OZ_CLASS_Square] = 3,
+};
+
 const OZ_fn_color OZ_PROTOCOL_RESOLVE_color[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_Circle] = (OZ_fn_color)Circle_color,
 	[OZ_CLASS_Square] = (OZ_fn_color)Square_color,
@@ -26,10 +37,6 @@ const OZ_fn_draw OZ_PROTOCOL_RESOLVE_draw[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_Square] = (OZ_fn_draw)Square_draw,
 };
 
-/* Weak default: returns -1 (no precision override).
- * OZLog.c provides the strong definition on Zephyr. */
-__attribute__((weak)) int _oz_get_log_precision(void) { return -1; }
-
 void OZObject_dispatch_free(struct OZObject *obj)
 {
 	switch (obj->_meta.class_id) {
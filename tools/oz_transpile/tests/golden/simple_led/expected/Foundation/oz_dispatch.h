@@ -19,9 +19,11 @@ enum oz_class_id_enum {
 	OZ_CLASS_COUNT = 2
 };
 
-/* Class introspection tables */
+/* Class introspection tables (class ids are assigned in DFS preorder,
+ * so each class's subclasses occupy [class_id, oz_class_subtree_end)) */
 extern const char *const oz_class_names[OZ_CLASS_COUNT];
 extern const uint8_t oz_superclass_id[OZ_CLASS_COUNT];
+extern const uint8_t oz_class_subtree_end[OZ_CLASS_COUNT];
 
 static inline const char *oz_name(uint8_t class_id)
 {
@@ -35,14 +37,28 @@ static inline uint8_t oz_superclass(uint8_t class_id)
 
 static inline bool oz_isKindOfClass(uint8_t class_id, uint8_t target_class_id)
 {
-	uint8_t cur = class_id;
-	while (cur != OZ_CLASS_COUNT) {
-		if (cur == target_class_id) {
-			return true;
-		}
-		cur = oz_superclass_id[cur];
-	}
-	return false;
+	return class_id >= target_class_id &&
+	       class_id < oz_class_subtree_end[target_class_id];
+}
+
+static inline bool oz_isMemberOfClass(uint8_t class_id, uint8_t target_class_id)
+{
+	return class_id == target_class_id;
+}
+
+/* Protocol conformance bitsets (superclass and protocol inheritance folded in) */
+enum oz_protocol_id_enum {
+	OZ_PROTO_OZToggleable = 0,
+	OZ_PROTO_COUNT = 1
+};
+
+#define OZ_PROTO_WORDS 1
+
+extern const uint32_t oz_class_protocols[OZ_CLASS_COUNT][OZ_PROTO_WORDS];
+
+static inline bool oz_conformsTo(uint8_t class_id, unsigned int proto_id)
+{
+	return (oz_class_protocols[class_id][proto_id >> 5] >> (proto_id & 31)) & 1u;
 }
 
 /* Protocol dispatch function pointer types */
@@ -69,4 +85,3 @@ void OZObject_dispatch_free(struct OZObject *obj);
 
 /* OZLog — formatted logging with %@ object support */
 void OZLog(const char *fmt, ...);
-int _oz_get_log_precision(void);
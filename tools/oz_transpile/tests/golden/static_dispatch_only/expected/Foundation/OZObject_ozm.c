@@ -7,7 +7,7 @@ OZ_SLAB_DEFINE(oz_slab_OZObject, sizeof(struct OZObject), 1, 4);
 
 struct OZObject *OZObject_retain(struct OZObject *self)
 {
-	if (self) {
+	if (self && !self->_meta.immortal) {
 		oz_atomic_inc(&self->_refcount);
 	}
 	return self;
@@ -16,9 +16,11 @@ const uint8_t oz_superclass_id[OZ_CLASS_COUNT] = {
 	[OZ_CLASS_Timer] = OZ_CLASS_OZObject,
 };
 
-/* Weak default: returns -1 (no precision override).
- * OZLog.c provides the strong definition on Zephyr. */
-__attribute__((weak)) int _oz_get_log_precision(void) { return -1; }
+const uint8_t oz_class_subtree_end[OZ_CLASS_COUNT] = {
+	[OZ_CLASS_OZObject] = 3,
+	[OZ_CLASS_Logger] = 2,
+	[OZ_CLASS_Timer] = 3,
+};
 
 void OZObject_dispatch_free(struct OZObject *obj)
 {
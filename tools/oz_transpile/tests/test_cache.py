@@ -0,0 +1,158 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import os
+import shutil
+import stat
+import sys
+import textwrap
+
+from oz_transpile.__main__ import main
+from oz_transpile.astdump import dump_all, parse_depfile
+from oz_transpile.cache import StatDigests, collect_cached
+from oz_transpile.emit import _write_file
+
+FIXTURE_DIR = os.path.join(os.path.dirname(__file__), "fixtures")
+LED_AST = os.path.join(FIXTURE_DIR, "simple_led.ast.json")
+
+
+def _mtimes(outdir):
+    return {os.path.join(root, f): os.stat(os.path.join(root, f)).st_mtime_ns
+            for root, _, files in os.walk(outdir) for f in files}
+
+
+class TestWriteFile:
+    def test_unchanged_content_keeps_mtime(self, tmp_path):
+        path = str(tmp_path / "a.c")
+        _write_file(path, "int a;\n")
+        os.utime(path, ns=(1, 1))
+        _write_file(path, "int a;\n")
+        assert os.stat(path).st_mtime_ns == 1
+        _write_file(path, "int b;\n")
+        assert os.stat(path).st_mtime_ns != 1
+        assert open(path).read() == "int b;\n"
+
+
+class TestCollectCached:
+    def test_reuses_until_ast_changes(self, tmp_path):
+        ast = tmp_path / "led.ast.json"
+        shutil.copy(LED_AST, ast)
+        digests = StatDigests()
+        first = collect_cached(str(ast), digests, tmp_path)
+        assert set(first.classes) == {"OZObject", "OZLed"}
+        assert (tmp_path / "led.ast.json.pickle").is_file()
+
+        again = collect_cached(str(ast), StatDigests(), tmp_path)
+        assert set(again.classes) == set(first.classes)
+
+        ast.write_text('{"kind": "TranslationUnitDecl", "inner": []}')
+        changed = collect_cached(str(ast), StatDigests(), tmp_path)
+        assert changed.classes == {}
+
+
+class TestIncrementalMain:
+    def _run(self, tmp_path, ast):
+        return main(["--input", str(ast), "--outdir", str(tmp_path / "out"),
+                     "--cache-dir", str(tmp_path / "cache"),
+                     "--manifest", str(tmp_path / "manifest.txt")])
+
+    def test_second_run_is_skipped(self, tmp_path, capsys):
+        ast = tmp_path / "led.ast.json"
+        shutil.copy(LED_AST, ast)
+        assert self._run(tmp_path, ast) == 0
+        manifest = (tmp_path / "manifest.txt").read_text()
+        before = _mtimes(tmp_path / "out")
+        capsys.readouterr()
+
+        assert self._run(tmp_path, ast) == 0
+        assert "up to date" in capsys.readouterr().err
+        assert (tmp_path / "manifest.txt").read_text() == manifest
+        assert _mtimes(tmp_path / "out") == before
+
+    def test_missing_output_reruns(self, tmp_path, capsys):
+        ast = tmp_path / "led.ast.json"
+        shutil.copy(LED_AST, ast)
+        assert self._run(tmp_path, ast) == 0
+        os.remove(tmp_path / "out" / "OZLed_ozm.c")
+        capsys.readouterr()
+
+        assert self._run(tmp_path, ast) == 0
+        assert "files generated" in capsys.readouterr().err
+        assert (tmp_path / "out" / "OZLed_ozm.c").is_file()
+
+    def test_changed_flags_rerun(self, tmp_path, capsys):
+        ast = tmp_path / "led.ast.json"
+        shutil.copy(LED_AST, ast)
+        assert self._run(tmp_path, ast) == 0
+        capsys.readouterr()
+        assert main(["--input", str(ast), "--outdir", str(tmp_path / "out"),
+                     "--cache-dir", str(tmp_path / "cache"),
+                     "--pool-sizes", "OZLed=3"]) == 0
+        assert "files generated" in capsys.readouterr().err
+        assert "sizeof(struct OZLed), 3," in (
+            tmp_path / "out" / "OZLed_ozm.c").read_text()
+
+
+class TestParseDepfile:
+    def test_continuations_and_escaped_spaces(self):
+        text = ("a.o: /src/a.m /inc/b.h \\\n"
+                "  /inc/with\\ space.h\n")
+        assert parse_depfile(text) == ["/src/a.m", "/inc/b.h",
+                                       "/inc/with space.h"]
+
+    def test_empty(self):
+        assert parse_depfile("") == []
+
+
+class TestDumpAll:
+    def _fake_clang(self, tmp_path):
+        """A 'clang' that logs each call and writes a depfile on -MF."""
+        script = tmp_path / "fake_clang"
+        script.write_text(textwrap.dedent(f"""\
+            #!{sys.executable}
+            import sys
+            args = sys.argv[1:]
+            src = args[args.index("-MF") - 2]
+            dep = args[args.index("-MF") + 1]
+            with open({str(tmp_path / "calls")!r}, "a") as f:
+                f.write(src + "\\n")
+            with open(dep, "w") as f:
+                f.write("x.o: " + src + " " + {str(tmp_path / "hdr.h")!r} + "\\n")
+            print('{{"kind": "TranslationUnitDecl", "src": "' + src + '"}}')
+        """))
+        script.chmod(script.stat().st_mode | stat.S_IEXEC)
+        return str(script)
+
+    def _calls(self, tmp_path):
+        path = tmp_path / "calls"
+        return path.read_text().split() if path.exists() else []
+
+    def test_only_changed_inputs_are_redumped(self, tmp_path):
+        clang = self._fake_clang(tmp_path)
+        (tmp_path / "hdr.h").write_text("int h;\n")
+        srcs = []
+        for name in ("A.m", "B.m"):
+            (tmp_path / name).write_text(f"// {name}\n")
+            srcs.append(str(tmp_path / name))
+        asts = [str(tmp_path / "ast" / "A_m.ast.json"),
+                str(tmp_path / "ast" / "B_m.ast.json")]
+        os.makedirs(tmp_path / "ast")
+
+        assert dump_all(clang, ["-DX"], srcs, asts) == srcs
+        assert (tmp_path / "ast" / "A_m.d").is_file()
+        assert (tmp_path / "ast" / "A_m.err.log").is_file()
+        assert dump_all(clang, ["-DX"], srcs, asts) == []
+
+        # Same bytes, new mtime: still a hit
+        os.utime(srcs[0], ns=(5, 5))
+        assert dump_all(clang, ["-DX"], srcs, asts) == []
+
+        (tmp_path / "B.m").write_text("// B changed\n")
+        assert dump_all(clang, ["-DX"], srcs, asts) == [srcs[1]]
+
+        # A shared header invalidates every dump that included it
+        (tmp_path / "hdr.h").write_text("int h2;\n")
+        assert dump_all(clang, ["-DX"], srcs, asts) == srcs
+
+        # So does a different command line
+        assert dump_all(clang, ["-DY"], srcs, asts) == srcs
+        assert len(self._calls(tmp_path)) == 7
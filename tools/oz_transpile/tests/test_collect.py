@@ -151,6 +151,25 @@ class TestCollectProtocol:
         proto = mod.protocols["OZToggleable"]
         assert any(m.selector == "toggle" for m in proto.methods)
 
+    def test_protocol_inheritance(self):
+        mod = clang_collect("""\
+#import <Foundation/OZObject.h>
+@protocol OZToggleable
+- (void)toggle;
+@end
+@protocol OZDimmable <OZToggleable>
+- (void)dim;
+@end
+""")
+        assert mod.protocols["OZDimmable"].protocols == ["OZToggleable"]
+
+    def test_protocol_inheritance_from_ast(self):
+        mod = collect({"kind": "TranslationUnitDecl", "inner": [
+            {"kind": "ObjCProtocolDecl", "name": "OZDimmable",
+             "protocols": [{"name": "OZToggleable"}], "inner": []},
+        ]})
+        assert mod.protocols["OZDimmable"].protocols == ["OZToggleable"]
+
 
 class TestCollectCategory:
     def test_category_merges(self):
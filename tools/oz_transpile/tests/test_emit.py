@@ -1,5 +1,6 @@
 # SPDX-License-Identifier: Apache-2.0
 
+import json
 import os
 import tempfile
 
@@ -9,7 +10,10 @@ from oz_transpile.emit import (
     _emit_synthesized_accessor, _emit_patched_source, _EmitCtx,
     _emit_include_replacement,
     _is_func_prototype, _extract_func_name, _extract_class_name,
-    _extract_decl_name,
+    _extract_decl_name, _dispatch_table_layout, _class_subtree_end,
+    _arc_optimize_body, _q31_constant, _count_alloc_calls,
+    _count_item_slots, _dict_index_words, _oz_string_hash,
+    _split_log_format,
 )
 from oz_transpile.model import (
     DispatchKind,
@@ -181,6 +185,1008 @@ class TestDispatchHeader:
         assert "OZLed_cls_greet(void)" in led_h
 
 
+def _sensor_module():
+    """OZObject -> {Sensor(read, reset) -> TempSensor(read), Led(toggle)}"""
+    m = OZModule()
+    empty = {"kind": "CompoundStmt", "inner": []}
+    m.classes["OZObject"] = OZClass("OZObject", methods=[
+        OZMethod("dealloc", OZType("void"), body_ast=empty),
+    ])
+    m.classes["Sensor"] = OZClass("Sensor", superclass="OZObject", methods=[
+        OZMethod("read", OZType("int"), body_ast=empty),
+        OZMethod("reset", OZType("void"), body_ast=empty),
+    ])
+    m.classes["TempSensor"] = OZClass("TempSensor", superclass="Sensor",
+                                      methods=[
+        OZMethod("read", OZType("int"), body_ast=empty),
+    ])
+    m.classes["Led"] = OZClass("Led", superclass="OZObject", methods=[
+        OZMethod("toggle", OZType("void"), body_ast=empty),
+        OZMethod("reset", OZType("void"), body_ast=empty),
+    ])
+    resolve(m)
+    return m
+
+
+class TestCompactDispatch:
+    def test_full_layout_has_no_offsets(self):
+        layout = _dispatch_table_layout(_sensor_module())
+        assert not layout["compact"]
+        assert layout["offsets"] == {}
+
+    def test_compact_slots_do_not_collide(self):
+        m = _sensor_module()
+        layout = _dispatch_table_layout(m, compact=True)
+        assert layout["compact"]
+        slots = [layout["offsets"][sel["c_sel"]] + e["class_id"]
+                 for sel in layout["vtable_sels"] for e in sel["entries"]]
+        assert len(slots) == len(set(slots))
+
+    def test_compact_table_smaller_and_bounded(self):
+        m = _sensor_module()
+        layout = _dispatch_table_layout(m, compact=True)
+        class_count = len(m.classes)
+        assert layout["table_size"] < layout["full_slots"]
+        for off in layout["offsets"].values():
+            assert off + class_count <= layout["table_size"]
+
+    def test_compact_emission(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, compact_dispatch=True)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        assert "OZ_PROTOCOL_RESOLVE_" not in hdr
+        assert "OZ_PROTOCOL_RESOLVE_" not in src
+        assert "OZ_SEL_OFFSET_reset = " in hdr
+        assert ("(OZ_fn_read)oz_dispatch_table[OZ_SEL_OFFSET_read + "
+                "((struct OZObject *)(obj))->_meta.class_id]") in hdr
+        assert ("[OZ_SEL_OFFSET_read + OZ_CLASS_TempSensor] = "
+                "(oz_imp_t)TempSensor_read,") in src
+
+    def test_report_note(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, compact_dispatch=True)
+        assert any("bytes full ->" in n and "bytes compact" in n
+                   for n in m.notes)
+
+
+def _send(selector, var, var_type, ret="void"):
+    """Synthetic [var selector] expression statement."""
+    return {
+        "kind": "ObjCMessageExpr", "selector": selector,
+        "receiverKind": "instance", "type": {"qualType": ret},
+        "inner": [{
+            "kind": "ImplicitCastExpr", "type": {"qualType": var_type},
+            "castKind": "LValueToRValue",
+            "inner": [{"kind": "DeclRefExpr",
+                       "referencedDecl": {"name": var},
+                       "type": {"qualType": var_type}}],
+        }],
+    }
+
+
+def _alloc(class_name):
+    return {"kind": "ObjCMessageExpr", "selector": "alloc",
+            "receiverKind": "class",
+            "classType": {"qualType": class_name},
+            "type": {"qualType": f"{class_name} *"}}
+
+
+def _devirt_source(allocs, stmt, var_type, devirtualize=True, **kwargs):
+    m = _sensor_module()
+    m.functions.append(OZFunction(
+        name="make", return_type=OZType("void"),
+        body_ast={"kind": "CompoundStmt", "inner": [
+            _alloc(c) for c in allocs]},
+    ))
+    m.functions.append(OZFunction(
+        name="poll", return_type=OZType("void"),
+        params=[OZParam("obj", OZType(var_type))],
+        body_ast={"kind": "CompoundStmt", "inner": [stmt]},
+    ))
+    with tempfile.TemporaryDirectory() as tmpdir:
+        emit(m, tmpdir, devirtualize=devirtualize, **kwargs)
+        return "".join(open(os.path.join(tmpdir, f)).read()
+                       for f in os.listdir(tmpdir) if f.endswith(".c"))
+
+
+class TestDevirtualize:
+    def test_id_single_impl_direct_call(self):
+        src = _devirt_source(["Led"], _send("reset", "obj", "id"), "id")
+        assert "Led_reset((struct Led *)obj)" in src
+        assert "OZ_PROTOCOL_SEND_reset" not in src
+
+    def test_id_two_impls_compare_chain(self):
+        src = _devirt_source(["Led", "Sensor"],
+                             _send("reset", "obj", "id"), "id")
+        assert "_oz_recv0->_meta.class_id == OZ_CLASS_Led ? " \
+               "Led_reset((struct Led *)_oz_recv0) : " \
+               "Sensor_reset((struct Sensor *)_oz_recv0)" in src
+        assert "OZ_PROTOCOL_SEND_reset" not in src
+
+    def test_inherited_impl_groups_classes(self):
+        src = _devirt_source(["Led", "Sensor", "TempSensor"],
+                             _send("reset", "obj", "id"), "id")
+        assert "Sensor_reset((struct Sensor *)_oz_recv0)" in src
+        assert "TempSensor_reset" not in src
+
+    def test_superclass_receiver_uses_instantiated_override(self):
+        src = _devirt_source(["TempSensor"],
+                             _send("read", "obj", "Sensor *", "int"),
+                             "Sensor *")
+        assert "TempSensor_read((struct TempSensor *)obj)" in src
+
+    def test_superclass_receiver_sees_both_overrides(self):
+        src = _devirt_source(["Sensor", "TempSensor"],
+                             _send("read", "obj", "Sensor *", "int"),
+                             "Sensor *")
+        assert "OZ_CLASS_Sensor ? Sensor_read(" in src
+        assert ": TempSensor_read((struct TempSensor *)_oz_recv0))" in src
+
+    def test_nothing_instantiated_keeps_vtable(self):
+        src = _devirt_source([], _send("reset", "obj", "id"), "id")
+        assert "OZ_PROTOCOL_SEND_reset(_oz_recv0)" in src
+
+    def test_disabled_keeps_vtable(self):
+        src = _devirt_source(["Led"], _send("reset", "obj", "id"), "id",
+                             devirtualize=False)
+        assert "OZ_PROTOCOL_SEND_reset(_oz_recv0)" in src
+
+
+class TestDispatchGuards:
+    def test_guard_uses_profiled_class(self):
+        src = _devirt_source([], _send("read", "obj", "id", "int"), "id",
+                             devirtualize=False,
+                             dispatch_guards={"read": "TempSensor"})
+        assert ("(_oz_recv0->_meta.class_id == OZ_CLASS_TempSensor ? "
+                "TempSensor_read((struct TempSensor *)_oz_recv0) : "
+                "OZ_PROTOCOL_SEND_read(_oz_recv0))") in src
+
+    def test_guard_calls_inherited_impl(self):
+        src = _devirt_source([], _send("reset", "obj", "id"), "id",
+                             devirtualize=False,
+                             dispatch_guards={"reset": "TempSensor"})
+        assert ("OZ_CLASS_TempSensor ? "
+                "Sensor_reset((struct Sensor *)_oz_recv0)") in src
+
+    def test_unprofiled_selector_unguarded(self):
+        src = _devirt_source([], _send("reset", "obj", "id"), "id",
+                             devirtualize=False,
+                             dispatch_guards={"read": "TempSensor"})
+        assert "_meta.class_id ==" not in src
+        assert "OZ_PROTOCOL_SEND_reset(_oz_recv0)" in src
+
+    def test_unknown_class_ignored(self):
+        src = _devirt_source([], _send("read", "obj", "id", "int"), "id",
+                             devirtualize=False,
+                             dispatch_guards={"read": "Missing"})
+        assert "_meta.class_id ==" not in src
+
+    def test_profile_instrumentation(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, dispatch_profile=True)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        assert "OZ_SEL_read," in hdr
+        assert "(OZ_DISPATCH_HIT(OZ_SEL_read, obj) OZ_PROTOCOL_RESOLVE_read" in hdr
+        assert '"read",' in src
+        assert 'getenv("OZ_DISPATCH_PROFILE_OUT")' in src
+
+    def test_no_instrumentation_by_default(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+        assert "OZ_DISPATCH_HIT" not in hdr
+
+
+class TestPoolStats:
+    def test_instrumentation(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, pool_stats=True)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+            led = open(os.path.join(tmpdir, "Led_ozh.h")).read()
+        assert "extern oz_atomic_t oz_pool_failures[OZ_CLASS_COUNT];" in hdr
+        assert "void oz_pool_stats_dump(void);" in hdr
+        assert "[OZ_CLASS_TempSensor] = &oz_slab_TempSensor," in src
+        assert 'getenv("OZ_POOL_PROFILE_OUT")' in src
+        assert "SHELL_CMD_REGISTER(oz_pools" in src
+        assert "oz_atomic_inc(&oz_pool_failures[OZ_CLASS_Led]);" in led
+
+    def test_no_instrumentation_by_default(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+            led = open(os.path.join(tmpdir, "Led_ozh.h")).read()
+        assert "oz_pool_failures" not in src
+        assert "oz_pool_failures" not in led
+
+
+class TestMutableStringPools:
+    def _emit(self, **kwargs):
+        m = _sensor_module()
+        m.classes["OZMutableString"] = OZClass("OZMutableString",
+                                               superclass="OZObject")
+        resolve(m)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, **kwargs)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        return hdr, src
+
+    def test_size_class_slabs(self):
+        hdr, src = self._emit()
+        assert "char *oz_mstring_buf_alloc(struct OZObject *heap," in hdr
+        assert "OZ_SLAB_DEFINE(oz_mstring_slab_32, 32, 4, 4);" in src
+        assert "OZ_SLAB_DEFINE(oz_mstring_slab_256, 256, 1, 4);" in src
+        assert "oz_mstring_failures" not in src
+
+    def test_max_size_adds_classes(self):
+        _, src = self._emit(mstring_max_size=1000)
+        assert "OZ_SLAB_DEFINE(oz_mstring_slab_512, 512, 1, 4);" in src
+        assert "OZ_SLAB_DEFINE(oz_mstring_slab_1024, 1024, 1, 4);" in src
+        assert "oz_mstring_slab_2048" not in src
+        assert "#define OZ_MSTRING_POOL_COUNT 6" in src
+
+    def test_max_size_drops_classes(self):
+        _, src = self._emit(mstring_max_size=64)
+        assert "#define OZ_MSTRING_POOL_COUNT 2" in src
+        assert "oz_mstring_slab_128" not in src
+
+    def test_pool_sizes_override_class(self):
+        _, src = self._emit(pool_sizes={"OZMutableString.64": 9})
+        assert "OZ_SLAB_DEFINE(oz_mstring_slab_64, 64, 9, 4);" in src
+
+    def test_pool_stats_rows(self):
+        _, src = self._emit(pool_stats=True)
+        assert "oz_atomic_inc(&oz_mstring_failures[i]);" in src
+        assert '"OZMutableString.%u %u %u %u"' in src
+
+    def test_absent_without_class(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        assert "oz_mstring" not in src
+
+
+def _log_call(fmt, *args, offset=120):
+    """CallExpr AST for OZLog(fmt, args...) as Clang spells it."""
+    def cast(node):
+        return {"kind": "ImplicitCastExpr", "inner": [node]}
+
+    def ref(name):
+        return cast({"kind": "DeclRefExpr",
+                     "referencedDecl": {"name": name}})
+    return {
+        "kind": "CallExpr",
+        "range": {"begin": {"offset": offset}},
+        "inner": [ref("OZLog"),
+                  cast({"kind": "StringLiteral", "value": fmt}),
+                  *[ref(a) for a in args]],
+    }
+
+
+class TestLogSpecialize:
+    def _emit(self, *calls, **kwargs):
+        m = _sensor_module()
+        m.classes["Led"].methods[0].body_ast = {
+            "kind": "CompoundStmt", "inner": list(calls)}
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, **kwargs)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Led_ozm.c")).read()
+        return hdr, src
+
+    def test_split_segments(self):
+        parts = _split_log_format(b"v=%d 100%% %s%@ %.2@|%08lx%c")
+        assert parts == [
+            ("lit", b"v="), ("arg", "oz_log_int", "%d", "int"),
+            ("lit", b" 100% "), ("arg", "oz_log_str", "%s", "const char *"),
+            ("obj", -1), ("lit", b" "), ("obj", 2), ("lit", b"|"),
+            ("arg", "oz_log_fmt", "%08lx", "unsigned long"),
+            ("arg", "oz_log_char", "%c", "int"),
+        ]
+
+    def test_split_rejects_unsupported(self):
+        assert _split_log_format(b"%f") is None
+        assert _split_log_format(b"%*d") is None
+        assert _split_log_format(b"trailing %") is None
+
+    def test_lowered_call(self):
+        hdr, src = self._emit(_log_call('"v=%d %@\\n"', "v", "obj"),
+                              log_specialize=True)
+        assert "struct oz_log_buf {" in hdr
+        assert "static void _oz_log_120(int a0, const void *a1)" in src
+        assert 'oz_log_lit(&b, "v=", 2);' in src
+        assert "oz_log_int(&b, a0);" in src
+        assert "oz_log_obj(&b, a1, -1);" in src
+        assert 'oz_log_lit(&b, "\\n", 1);' in src
+        assert "_oz_log_120(v, obj);" in src
+        assert "OZLog(" not in src
+
+    def test_mismatched_args_fall_back(self):
+        _, src = self._emit(_log_call('"%d %d"', "v"), log_specialize=True)
+        assert "OZLog(\"%d %d\", v);" in src
+        assert "_oz_log_" not in src
+
+    def test_off_by_default(self):
+        hdr, src = self._emit(_log_call('"v=%d"', "v"))
+        assert "oz_log_buf" not in hdr
+        assert "OZLog(\"v=%d\", v);" in src
+
+
+class TestLogDeferred:
+    def _emit(self, *calls, **kwargs):
+        m = _sensor_module()
+        m.classes["Led"].methods[0].body_ast = {
+            "kind": "CompoundStmt", "inner": list(calls)}
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, log_deferred=True, **kwargs)
+            fdir = os.path.join(tmpdir, "Foundation")
+            hdr = open(os.path.join(fdir, "oz_dispatch.h")).read()
+            disp = open(os.path.join(fdir, "oz_dispatch.c")).read()
+            src = open(os.path.join(tmpdir, "Led_ozm.c")).read()
+            log_dict = json.load(open(os.path.join(fdir, "oz_log_dict.json")))
+        return hdr, disp, src, log_dict
+
+    def test_record_writer(self):
+        hdr, disp, src, _ = self._emit(
+            _log_call('"v=%d %s %lx %@"', "v", "s", "x", "obj"))
+        assert "static inline int oz_logq_str(" in hdr
+        assert "void oz_logq_commit(uint16_t id" in disp
+        assert "int oz_log_drain(uint8_t *out, int max)" in disp
+        assert ("static void _oz_log_120(int a0, const char *a1, "
+                "unsigned long a2, const void *a3)") in src
+        assert "uint8_t rec[12 + OZ_LOGQ_STR_BYTES + OZ_LOGQ_OBJ_BYTES];" in src
+        assert "n = oz_logq_u32(rec, n, (uint32_t)a0);" in src
+        assert "n = oz_logq_str(rec, n, a1);" in src
+        assert "n = oz_logq_u64(rec, n, (uint64_t)a2);" in src
+        assert "n = oz_logq_obj(rec, n, a3);" in src
+        assert "oz_logq_commit(0, rec, n);" in src
+        assert "oz_log_lit(" not in src
+
+    def test_dictionary(self):
+        _, _, _, log_dict = self._emit(
+            _log_call('"a=%d\\n"', "v", offset=10),
+            _log_call('"%.2@ done"', "obj", offset=20),
+            _log_call('"a=%d\\n"', "w", offset=30))
+        assert log_dict["version"] == 1
+        assert [c["name"] for c in log_dict["classes"]][0] == "OZObject"
+        assert log_dict["messages"] == [
+            {"id": 0, "fmt": "a=%d\n",
+             "parts": [["lit", "a="], ["arg", "%d", "i32"], ["lit", "\n"]]},
+            {"id": 1, "fmt": "%.2@ done",
+             "parts": [["obj", 2], ["lit", " done"]]},
+        ]
+
+    def test_no_args(self):
+        _, _, src, _ = self._emit(_log_call('"boot"'))
+        assert "oz_logq_commit(0, NULL, 0);" in src
+
+    def test_encode_dispatch_only_when_implemented(self):
+        _, disp, _, _ = self._emit(_log_call('"%@"', "obj"))
+        assert "OZ_PROTOCOL_SEND_encode_maxLength_" not in disp
+        assert "rec[n + 2] = (uint8_t)len;" in disp
+
+
+class TestClassSubtreeEnd:
+    def test_subtree_end_table(self):
+        m = _sensor_module()
+        end = _class_subtree_end(m)
+        ids = {n: c.class_id for n, c in m.classes.items()}
+        assert end["OZObject"] == len(m.classes)
+        assert end["Sensor"] == ids["TempSensor"] + 1
+        assert end["TempSensor"] == ids["TempSensor"] + 1
+        assert end["Led"] == ids["Led"] + 1
+
+    def test_range_check_emitted(self):
+        m = _sensor_module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        assert "class_id < oz_class_subtree_end[target_class_id]" in hdr
+        assert "oz_isMemberOfClass(" in hdr
+        assert "oz_superclass_id[cur]" not in hdr
+        assert "[OZ_CLASS_OZObject] = 4," in src
+
+    def test_injected_spinlock_keeps_preorder(self):
+        m = _sensor_module()
+        m.functions.append(OZFunction(
+            name="locked", return_type=OZType("void"),
+            body_ast={"kind": "CompoundStmt", "inner": [
+                {"kind": "ObjCAtSynchronizedStmt", "inner": []}]},
+        ))
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+        ids = sorted(c.class_id for c in m.classes.values())
+        assert ids == list(range(len(m.classes)))
+        end = _class_subtree_end(m)
+        assert end["Sensor"] - m.classes["Sensor"].class_id == 2
+
+
+class TestProtocolConformance:
+    def _module(self):
+        m = _sensor_module()
+        m.protocols["Resettable"] = OZProtocol("Resettable")
+        m.protocols["Readable"] = OZProtocol("Readable",
+                                             protocols=["Resettable"])
+        m.classes["Sensor"].protocols = ["Readable"]
+        m.classes["Led"].protocols = ["Resettable"]
+        return m
+
+    def test_inherited_conformance_folded(self):
+        m = self._module()
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        assert "OZ_PROTO_Readable = 0," in hdr
+        assert "OZ_PROTO_Resettable = 1," in hdr
+        assert "static inline bool oz_conformsTo(" in hdr
+        assert ("[OZ_CLASS_TempSensor] = { 0x00000003u }, "
+                "/* Readable, Resettable */") in src
+        assert "[OZ_CLASS_Led] = { 0x00000002u }, /* Resettable */" in src
+        assert "[OZ_CLASS_OZObject] = {" not in src
+
+    def test_multiword_bitset(self):
+        m = _sensor_module()
+        for i in range(40):
+            m.protocols[f"P{i:02d}"] = OZProtocol(f"P{i:02d}")
+        m.classes["Led"].protocols = ["P35"]
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+            src = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.c")).read()
+        assert "#define OZ_PROTO_WORDS 2" in hdr
+        assert "[OZ_CLASS_Led] = { 0x00000000u, 0x00000008u }, /* P35 */" in src
+
+    def test_no_protocols_no_table(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(_sensor_module(), tmpdir)
+            hdr = open(os.path.join(tmpdir, "Foundation", "oz_dispatch.h")).read()
+        assert "oz_conformsTo" not in hdr
+
+
+
+def _arc_lines(*stmts):
+    return "{\n" + "".join(f"\t{st}\n" for st in stmts) + "}"
+
+
+_RET = "OZObject_retain((struct OZObject *){});"
+_REL = "OZObject_release((struct OZObject *){});"
+
+
+class TestArcOptimize:
+    def test_pair_without_release_point_removed(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("obj"), "int x = obj->_meta.class_id;",
+            _REL.format("obj")), "OZObject")
+        assert n == 1
+        assert "_retain" not in text and "_release" not in text
+        assert "int x = obj->_meta.class_id;" in text
+
+    def test_call_in_between_keeps_pair(self):
+        body = _arc_lines(_RET.format("obj"), "OZ_SEND_reset(other);",
+                          _REL.format("obj"))
+        text, n = _arc_optimize_body(body, "OZObject")
+        assert n == 0
+        assert text == body
+
+    def test_param_forwarded_into_ivar_store(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("child"), _RET.format("child"),
+            _REL.format("self->_child"), "self->_child = child;",
+            _REL.format("child")), "OZObject")
+        assert n == 1
+        assert text == _arc_lines(
+            _RET.format("child"), _REL.format("self->_child"),
+            "self->_child = child;")
+
+    def test_control_flow_ends_run(self):
+        body = _arc_lines(_RET.format("obj"), "if (flag) {",
+                          _REL.format("obj"), "return;", "}",
+                          _REL.format("obj"))
+        text, n = _arc_optimize_body(body, "OZObject")
+        assert n == 0
+
+    def test_reassignment_ends_run(self):
+        body = _arc_lines(_RET.format("a"), "a = b;", _REL.format("a"))
+        assert _arc_optimize_body(body, "OZObject")[1] == 0
+
+    def test_nested_pairs_both_removed(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("obj"), _RET.format("obj"), _REL.format("obj"),
+            _REL.format("obj")), "OZObject")
+        assert n == 2
+        assert text == _arc_lines()
+
+    def test_nested_inner_pair_removed_across_calls(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("obj"), _RET.format("obj"), "OZ_SEND_reset(other);",
+            _REL.format("obj"), "OZ_SEND_reset(obj);",
+            _REL.format("obj")), "OZObject")
+        assert n == 1
+        assert text == _arc_lines(
+            _RET.format("obj"), "OZ_SEND_reset(other);",
+            "OZ_SEND_reset(obj);", _REL.format("obj"))
+
+    def test_nested_alias_release_keeps_inner_pair(self):
+        # Strong local reassignment: retain(rhs); release(var); var = rhs
+        body = _arc_lines(
+            _RET.format("p"), "a = NULL;",
+            _RET.format("p"), _REL.format("a"), "a = p;",
+            _REL.format("a"), "a = NULL;",
+            "Foo_clear(self);", "Bar_doIt(p);",
+            _REL.format("a"), _REL.format("p"))
+        text, n = _arc_optimize_body(body, "OZObject")
+        assert n == 0
+        assert text == body
+
+    def test_nested_alias_kept_past_release_still_forwards(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("p"), _RET.format("p"), _REL.format("a"),
+            "a = p;", _REL.format("p")), "OZObject")
+        assert n == 1
+        assert text == _arc_lines(_RET.format("p"), _REL.format("a"),
+                                  "a = p;")
+
+    def test_unbalanced_nesting_keeps_extra_retain(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("obj"), _RET.format("obj"),
+            _REL.format("obj")), "OZObject")
+        assert n == 1
+        assert text == _arc_lines(_RET.format("obj"))
+
+    def test_pair_inside_branch_removed_outer_kept(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("obj"), "if (flag) {", _RET.format("obj"),
+            _REL.format("obj"), "}", "OZ_SEND_reset(other);",
+            _REL.format("obj")), "OZObject")
+        assert n == 1
+        assert text == _arc_lines(
+            _RET.format("obj"), "if (flag) {", "}",
+            "OZ_SEND_reset(other);", _REL.format("obj"))
+
+    def test_inner_release_in_branch_keeps_both(self):
+        body = _arc_lines(_RET.format("obj"), _RET.format("obj"),
+                          "if (flag) {", _REL.format("obj"), "}",
+                          _REL.format("obj"))
+        text, n = _arc_optimize_body(body, "OZObject")
+        assert n == 0
+        assert text == body
+
+    def test_retain_in_one_branch_release_after(self):
+        body = _arc_lines("if (flag) {", _RET.format("obj"), "} else {",
+                          "OZ_SEND_reset(obj);", "}", _REL.format("obj"))
+        text, n = _arc_optimize_body(body, "OZObject")
+        assert n == 0
+        assert text == body
+
+    def test_reassignment_between_nested_retains(self):
+        body = _arc_lines(_RET.format("obj"), "obj = other;",
+                          _RET.format("obj"), "OZ_SEND_reset(obj);",
+                          _REL.format("obj"))
+        text, n = _arc_optimize_body(body, "OZObject")
+        assert n == 0
+        assert text == body
+
+    def test_braces_in_string_literal_ignored(self):
+        text, n = _arc_optimize_body(_arc_lines(
+            _RET.format("obj"), 'const char *s = "{ f(x) }";',
+            _REL.format("obj")), "OZObject")
+        assert n == 1
+
+    def test_emit_reports_per_function(self):
+        m = _sensor_module()
+        m.functions.append(OZFunction(
+            name="touch", return_type=OZType("void"),
+            params=[OZParam("obj", OZType("Led *"))],
+            body_ast={"kind": "CompoundStmt", "inner": []},
+        ))
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir, arc_optimize=True)
+            src = "".join(open(os.path.join(tmpdir, f)).read()
+                          for f in os.listdir(tmpdir) if f.endswith(".c"))
+        assert "OZObject_retain((struct OZObject *)obj)" not in src
+        assert "arc: touch: eliminated 1 retain/release pair" in m.notes
+
+    def test_disabled_by_default(self):
+        m = _sensor_module()
+        m.functions.append(OZFunction(
+            name="touch", return_type=OZType("void"),
+            params=[OZParam("obj", OZType("Led *"))],
+            body_ast={"kind": "CompoundStmt", "inner": []},
+        ))
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            src = "".join(open(os.path.join(tmpdir, f)).read()
+                          for f in os.listdir(tmpdir) if f.endswith(".c"))
+        assert "OZObject_retain((struct OZObject *)obj)" in src
+        assert not any(n.startswith("arc:") for n in m.notes)
+
+
+def _emit_sensor(**kwargs):
+    """Emit _sensor_module() and return (module, {basename: content})."""
+    m = _sensor_module()
+    with tempfile.TemporaryDirectory() as tmpdir:
+        emit(m, tmpdir, **kwargs)
+        out = {}
+        for root, _, files in os.walk(tmpdir):
+            for f in files:
+                out[f] = open(os.path.join(root, f)).read()
+    return m, out
+
+
+class TestNonatomicRefcount:
+    def test_subclasses_marked_confined(self):
+        _, out = _emit_sensor(nonatomic_rc=["Sensor"])
+        assert "obj->base._meta.thread_confined = 1;" in out["Sensor_ozh.h"]
+        assert ("obj->base.base._meta.thread_confined = 1;"
+                in out["TempSensor_ozh.h"])
+        assert "thread_confined" not in out["Led_ozh.h"]
+
+    def test_root_retain_release_branch(self):
+        _, out = _emit_sensor(nonatomic_rc=["Led"])
+        src = out["OZObject_ozm.c"]
+        assert "oz_nonatomic_inc(&self->_refcount);" in src
+        assert "last = oz_nonatomic_dec_and_test(&self->_refcount);" in src
+        assert "oz_thread_is_self(self->_oz_owner)" in src
+        assert "oz_thread_id_t _oz_owner;" in out["OZObject_ozh.h"]
+        assert "_oz_owner = oz_thread_self();" in out["Led_ozh.h"]
+
+    def test_default_is_atomic_only(self):
+        _, out = _emit_sensor()
+        assert "oz_nonatomic" not in out["OZObject_ozm.c"]
+        assert "_oz_owner" not in out["OZObject_ozh.h"]
+
+    def test_unknown_class_warns(self):
+        m, _ = _emit_sensor(nonatomic_rc=["Nope"])
+        assert any("Nope" in d for d in m.diagnostics)
+
+
+class TestDeferredDealloc:
+    def test_release_pushes_and_drains(self):
+        _, out = _emit_sensor(deferred_dealloc=True)
+        src = out["OZObject_ozm.c"]
+        assert "oz_atomic_set_link(&self->_refcount, _oz_dealloc_head);" in src
+        assert "_oz_dealloc_head = self;" in src
+        assert "oz_dealloc_drain();" in src
+        release = src[src.index("void OZObject_release("):]
+        release = release[:release.index("\n}\n")]
+        assert "OZ_PROTOCOL_SEND_dealloc" not in release
+
+    def test_drain_is_bounded(self):
+        _, out = _emit_sensor(deferred_dealloc=True)
+        src = out["OZObject_ozm.c"]
+        assert "for (unsigned int n = 0; n < OZ_DEALLOC_DRAIN_BATCH; n++) {" in src
+        assert "_oz_dealloc_head = oz_atomic_get_link(&obj->_refcount);" in src
+        assert "oz_atomic_init(&obj->_refcount, 0);" in src
+        assert "void oz_dealloc_drain(void);" in out["OZObject_ozh.h"]
+        assert "oz_dealloc_drain" not in out["Led_ozh.h"]
+
+    def test_default_deallocs_inline(self):
+        _, out = _emit_sensor()
+        assert "_oz_dealloc_head" not in out["OZObject_ozm.c"]
+        assert "OZ_PROTOCOL_SEND_dealloc((struct OZObject *)self);" in out["OZObject_ozm.c"]
+        assert "oz_dealloc_drain" not in out["OZObject_ozh.h"]
+
+
+class TestDeferredRelease:
+    def test_api_only(self):
+        _, out = _emit_sensor(deferred_release=[])
+        src = out["OZObject_ozm.c"]
+        assert "void OZObject_releaseDeferred(struct OZObject *self)" in src
+        assert "static OZ_WORK_DEFINE(_oz_release_work, _oz_release_work_handler);" in src
+        assert "oz_atomic_ptr_cas((void **)&_oz_release_queue," in src
+        assert "void oz_release_queue_drain(void);" in out["OZObject_ozh.h"]
+        # No class selected: plain release never checks the flag
+        assert "self->_meta.deferred_release" not in src
+
+    def test_selected_subtree_marked(self):
+        _, out = _emit_sensor(deferred_release=["Sensor"])
+        assert "obj->base._meta.deferred_release = 1;" in out["Sensor_ozh.h"]
+        assert ("obj->base.base._meta.deferred_release = 1;"
+                in out["TempSensor_ozh.h"])
+        assert "deferred_release" not in out["Led_ozh.h"]
+        release = out["OZObject_ozm.c"]
+        release = release[release.index("void OZObject_release("):]
+        assert "if (self->_meta.deferred_release) {" in release
+        assert "_oz_release_enqueue(self);" in release
+
+    def test_disabled_by_default(self):
+        _, out = _emit_sensor()
+        assert "releaseDeferred" not in out["OZObject_ozh.h"]
+        assert "_oz_release_queue" not in out["OZObject_ozm.c"]
+
+    def test_unknown_class_warns(self):
+        m, _ = _emit_sensor(deferred_release=["Nope"])
+        assert any("--deferred-release" in d and "Nope" in d
+                   for d in m.diagnostics)
+
+
+def _boxed(kind, value, negate=False):
+    lit = {"kind": kind, "value": value}
+    if negate:
+        lit = {"kind": "UnaryOperator", "opcode": "-", "inner": [lit]}
+    return {"kind": "ObjCBoxedExpr", "type": {"qualType": "OZQ31 *"},
+            "inner": [lit]}
+
+
+def _q31_module(*exprs):
+    m = _sensor_module()
+    m.classes["OZQ31"] = OZClass("OZQ31", superclass="OZObject", ivars=[
+        OZIvar("_raw", OZType("int32_t")),
+        OZIvar("_shift", OZType("uint8_t")),
+    ])
+    m.functions.append(OZFunction(
+        name="numbers", return_type=OZType("void"),
+        body_ast={"kind": "CompoundStmt", "inner": list(exprs)},
+    ))
+    resolve(m)
+    return m
+
+
+class TestQ31Constants:
+    def test_int_encoding_matches_runtime(self):
+        assert _q31_constant(_boxed("IntegerLiteral", "42")) == (1409286144, 6)
+        assert _q31_constant(_boxed("IntegerLiteral", "0")) == (0, 0)
+        assert (_q31_constant(_boxed("IntegerLiteral", "128", negate=True))
+                == (-1073741824, 8))
+
+    def test_float_encoding_matches_runtime(self):
+        assert _q31_constant(_boxed("FloatingLiteral", "1.5")) == (1610612736, 1)
+        assert _q31_constant(_boxed("FloatingLiteral", "3.14")) == (1685774720, 2)
+        assert (_q31_constant(_boxed("FloatingLiteral", "0.75", negate=True))
+                == (-1610612736, 0))
+
+    def test_non_literal_not_folded(self):
+        node = {"kind": "ObjCBoxedExpr", "inner": [
+            {"kind": "DeclRefExpr", "referencedDecl": {"name": "x"},
+             "type": {"qualType": "int"}}]}
+        assert _q31_constant(node) is None
+        assert _q31_constant(_boxed("IntegerLiteral", "4294967295")) is None
+
+    def test_emitted_as_static_const(self):
+        m = _q31_module(_boxed("IntegerLiteral", "42"),
+                        _boxed("IntegerLiteral", "42"))
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            src = "".join(open(os.path.join(tmpdir, f)).read()
+                          for f in os.listdir(tmpdir) if f.endswith(".c"))
+        assert src.count("static const struct OZQ31 _oz_q31_54000000_6 = "
+                         "{{{.class_id = OZ_CLASS_OZQ31, .immortal = 1}, 1}, "
+                         "1409286144, 6};") == 1
+        assert src.count("(struct OZQ31 *)&_oz_q31_54000000_6") == 2
+        assert "OZQ31_fixedWithInt32_" not in src
+
+    def test_constant_literals_take_no_slab_block(self):
+        m = _q31_module(_boxed("IntegerLiteral", "1"),
+                        _boxed("FloatingLiteral", "2.5"))
+        assert "OZQ31" not in _count_alloc_calls(m)
+
+    def test_root_retain_skips_immortal(self):
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(_sensor_module(), tmpdir)
+            src = open(os.path.join(tmpdir, "Foundation",
+                                    "OZObject_ozm.c")).read()
+        assert "if (self && !self->_meta.immortal) {" in src
+
+
+def _str_lit(value, line):
+    return {"kind": "ObjCStringLiteral", "loc": {"line": line, "col": 1},
+            "type": {"qualType": "OZString *"},
+            "inner": [{"kind": "StringLiteral", "value": f'"{value}"'}]}
+
+
+def _collection_module(*exprs):
+    m = _q31_module(*exprs)
+    m.classes["OZString"] = OZClass("OZString", superclass="OZObject", ivars=[
+        OZIvar("_length", OZType("unsigned int")),
+        OZIvar("_hash", OZType("unsigned int")),
+        OZIvar("_data", OZType("const char *")),
+    ])
+    m.classes["OZArray"] = OZClass("OZArray", superclass="OZObject", ivars=[
+        OZIvar("_items", OZType("__unsafe_unretained id *")),
+        OZIvar("_count", OZType("unsigned int")),
+    ])
+    m.classes["OZDictionary"] = OZClass(
+        "OZDictionary", superclass="OZObject", ivars=[
+            OZIvar("_keys", OZType("__unsafe_unretained id *")),
+            OZIvar("_values", OZType("__unsafe_unretained id *")),
+            OZIvar("_count", OZType("unsigned int")),
+        ])
+    resolve(m)
+    return m
+
+
+def _collection_source(*exprs):
+    m = _collection_module(*exprs)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        emit(m, tmpdir)
+        return m, "".join(open(os.path.join(tmpdir, f)).read()
+                          for f in os.listdir(tmpdir) if f.endswith(".c"))
+
+
+class TestConstantCollections:
+    def test_string_array_is_static_immortal(self):
+        arr = {"kind": "ObjCArrayLiteral", "inner": [
+            _str_lit("a", 1), _str_lit("b", 2)]}
+        m, src = _collection_source(arr)
+        assert ("static struct OZObject *const _oz_arr_const0_items[] = {"
+                "(struct OZObject *)(struct OZString *)&_oz_str_L1_C1, "
+                "(struct OZObject *)(struct OZString *)&_oz_str_L2_C1};") in src
+        assert ("static struct OZArray _oz_arr_const0 = {.base = "
+                "{{.class_id = OZ_CLASS_OZArray, .immortal = 1}, 1}, "
+                "._items = (struct OZObject **)_oz_arr_const0_items, "
+                "._count = 2};") in src
+        assert "OZArray_initWithItems" not in src
+        assert _count_item_slots(m) == 0
+        assert "OZArray" not in _count_alloc_calls(m)
+
+    def test_dictionary_keys_then_values(self):
+        d = {"kind": "ObjCDictionaryLiteral", "inner": [
+            _str_lit("k", 1), _boxed("IntegerLiteral", "1"),
+            _str_lit("j", 2), _boxed("IntegerLiteral", "2")]}
+        _, src = _collection_source(d)
+        assert ("_oz_dict_const0_items[] = {"
+                "(struct OZObject *)(struct OZString *)&_oz_str_L1_C1, "
+                "(struct OZObject *)(struct OZString *)&_oz_str_L2_C1, "
+                "(struct OZObject *)(struct OZQ31 *)&_oz_q31_40000000_1, "
+                "(struct OZObject *)(struct OZQ31 *)&_oz_q31_40000000_2};"
+                ) in src
+        assert ("._keys = (struct OZObject **)_oz_dict_const0_items, "
+                "._values = (struct OZObject **)_oz_dict_const0_items + 2, "
+                "._count = 2, ") in src
+
+    def test_string_literal_hash_precomputed(self):
+        arr = {"kind": "ObjCArrayLiteral", "inner": [
+            _str_lit("k", 1), _str_lit("a\\tb", 2)]}
+        _, src = _collection_source(arr)
+        # FNV-1a("k"); escapes decode to bytes before length and hash
+        assert "1, 0xee0c38ea, \"k\"};" in src
+        tab_hash = _oz_string_hash(b"a\tb")
+        assert f"3, 0x{tab_hash:08x}, " in src
+
+    def test_constant_dictionary_static_index(self):
+        d = {"kind": "ObjCDictionaryLiteral", "inner": [
+            _str_lit("k", 1), _boxed("IntegerLiteral", "1"),
+            _str_lit("j", 2), _boxed("IntegerLiteral", "2")]}
+        _, src = _collection_source(d)
+        # hash("k") & 3 == 2 -> slot of key 0, hash("j") & 3 == 1 -> key 1
+        assert ("static const uint16_t _oz_dict_const0_index[] = "
+                "{0, 2, 1, 0};") in src
+        assert ("._index = (uint16_t *)_oz_dict_const0_index, "
+                "._mask = 3};") in src
+
+    def test_constant_dictionary_identity_key_scans(self):
+        d = {"kind": "ObjCDictionaryLiteral", "inner": [
+            {"kind": "ObjCArrayLiteral", "inner": []},
+            _boxed("IntegerLiteral", "1")]}
+        _, src = _collection_source(d)
+        assert "_oz_dict_const" in src
+        assert "._index" not in src
+
+    def test_dynamic_dictionary_reserves_index_slots(self):
+        d = {"kind": "ObjCDictionaryLiteral", "inner": [
+            _str_lit("k", 1),
+            {"kind": "DeclRefExpr", "referencedDecl": {"name": "x"},
+             "type": {"qualType": "id"}}]}
+        m, src = _collection_source(d)
+        assert "OZDictionary_initWithKeysValues" in src
+        assert _count_item_slots(m) == 2 + _dict_index_words(1)
+
+    def test_nested_and_empty(self):
+        arr = {"kind": "ObjCArrayLiteral", "inner": [
+            {"kind": "ObjCArrayLiteral", "inner": []}]}
+        _, src = _collection_source(arr)
+        assert "._items = (struct OZObject **)0, ._count = 0};" in src
+        assert "(struct OZArray *)&_oz_arr_const" in src
+
+    def test_non_constant_element_keeps_dynamic_path(self):
+        arr = {"kind": "ObjCArrayLiteral", "inner": [
+            _str_lit("a", 1),
+            {"kind": "DeclRefExpr", "referencedDecl": {"name": "x"},
+             "type": {"qualType": "id"}}]}
+        m, src = _collection_source(arr)
+        assert "_oz_arr_const" not in src
+        assert _count_item_slots(m) == 2
+
+
+def _forin(var, var_type, coll, coll_type, body=None):
+    """Synthetic for (var_type var in coll) body."""
+    return {"kind": "ObjCForCollectionStmt", "inner": [
+        {"kind": "DeclStmt", "inner": [{
+            "kind": "VarDecl", "name": var,
+            "type": {"qualType": var_type}}]},
+        {"kind": "ImplicitCastExpr", "type": {"qualType": coll_type},
+         "castKind": "LValueToRValue",
+         "inner": [{"kind": "DeclRefExpr",
+                    "referencedDecl": {"name": coll},
+                    "type": {"qualType": coll_type}}]},
+        body or {"kind": "CompoundStmt", "inner": []},
+    ]}
+
+
+def _forin_source(stmt, coll_type, array_subclass=False):
+    empty = {"kind": "CompoundStmt", "inner": []}
+    m = OZModule()
+    m.classes["OZObject"] = OZClass("OZObject")
+    m.classes["Sensor"] = OZClass("Sensor", superclass="OZObject", methods=[
+        OZMethod("reset", OZType("void"), body_ast=empty),
+    ])
+    m.classes["OZArray"] = OZClass("OZArray", superclass="OZObject", ivars=[
+        OZIvar("_items", OZType("__unsafe_unretained id *")),
+        OZIvar("_count", OZType("unsigned int")),
+    ], protocols=["IteratorProtocol"])
+    m.protocols["IteratorProtocol"] = OZProtocol("IteratorProtocol", methods=[
+        OZMethod("countByEnumeratingWithState:objects:count:",
+                 OZType("unsigned long"), params=[
+                     OZParam("state", OZType("struct NSFastEnumerationState *")),
+                     OZParam("stackbuf", OZType("__unsafe_unretained id *")),
+                     OZParam("len", OZType("unsigned long"))]),
+    ])
+    if array_subclass:
+        m.classes["Ring"] = OZClass("Ring", superclass="OZArray")
+    m.functions.append(OZFunction(
+        name="poll", return_type=OZType("void"),
+        params=[OZParam("coll", OZType(coll_type))],
+        body_ast={"kind": "CompoundStmt", "inner": [stmt]},
+    ))
+    resolve(m)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        emit(m, tmpdir)
+        return "".join(open(os.path.join(tmpdir, f)).read()
+                       for f in os.listdir(tmpdir) if f.endswith(".c"))
+
+
+class TestForInLowering:
+    def test_static_array_indexes_items(self):
+        body = {"kind": "CompoundStmt", "inner": [
+            _send("reset", "s", "Sensor *")]}
+        src = _forin_source(_forin("s", "Sensor *", "coll", "OZArray *", body),
+                            "OZArray *")
+        assert "struct OZArray *_oz_coll0 = (struct OZArray *)coll;" in src
+        assert ("for (unsigned int _oz_i0 = 0; "
+                "_oz_i0 < _oz_coll0->_count; _oz_i0++) {") in src
+        assert "struct Sensor * s = (struct Sensor *)_oz_coll0->_items[_oz_i0];" in src
+        assert "OZ_PROTOCOL_SEND_countByEnumerating" not in src
+
+    def test_id_collection_uses_stack_cursor(self):
+        src = _forin_source(_forin("obj", "id", "coll", "id"), "id")
+        assert "struct NSFastEnumerationState _oz_state0 = {0};" in src
+        assert "struct OZObject *_oz_buf0[OZ_FORIN_BATCH];" in src
+        assert "_oz_n0 = OZ_PROTOCOL_SEND_countByEnumeratingWithState_objects_count_(" in src
+        assert "_oz_coll0, &_oz_state0, _oz_buf0, OZ_FORIN_BATCH);" in src
+        assert "struct OZObject * obj = _oz_state0.itemsPtr[_oz_i0];" in src
+
+    def test_array_subclass_keeps_dispatch(self):
+        src = _forin_source(_forin("obj", "id", "coll", "OZArray *"),
+                            "OZArray *", array_subclass=True)
+        assert "_oz_coll0->_items" not in src
+        assert "OZ_PROTOCOL_SEND_countByEnumeratingWithState_objects_count_(" in src
+
+    def test_unused_loop_var_is_voided(self):
+        src = _forin_source(_forin("obj", "id", "coll", "OZArray *"),
+                            "OZArray *")
+        assert "(void)obj;" in src
+
+    def test_nested_loops_get_distinct_cursors(self):
+        inner = _forin("b", "id", "coll", "id")
+        outer = _forin("a", "id", "coll", "id",
+                       {"kind": "CompoundStmt", "inner": [inner]})
+        src = _forin_source(outer, "id")
+        assert "_oz_state0" in src
+        assert "_oz_state1" in src
+
+
 class TestClassHeader:
     def test_struct_with_base(self):
         _, out = clang_emit(_LED_SOURCE)
@@ -237,11 +1243,11 @@ class TestClassHeader:
         assert "_oz_block_" not in root_src
 
     def test_root_struct_with_atomic_props(self):
-        """Root struct includes _oz_prop_lock when atomic properties exist."""
+        """Root struct includes _oz_prop_lock when wide atomic properties exist."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 @interface Car : OZObject
-@property int speed;
+@property double speed;
 @end
 @implementation Car
 @synthesize speed = _speed;
@@ -250,6 +1256,20 @@ class TestClassHeader:
         content = out["Foundation/OZObject_ozh.h"]
         assert "oz_spinlock_t _oz_prop_lock;" in content
 
+    def test_root_struct_lockfree_atomic_props(self):
+        """Word-sized atomic properties need no _oz_prop_lock."""
+        _, out = clang_emit("""\
+#import <Foundation/OZObject.h>
+@interface Car : OZObject
+@property int speed;
+@end
+@implementation Car
+@synthesize speed = _speed;
+@end
+""")
+        content = out["Foundation/OZObject_ozh.h"]
+        assert "_oz_prop_lock" not in content
+
 
 class TestClassSource:
     def test_method_body(self):
@@ -1362,13 +2382,13 @@ void test_func(void) {
                 break
 
     def test_array_literal(self):
-        """ObjCArrayLiteral -> dynamic OZArray via OZArray_initWithItems."""
+        """ObjCArrayLiteral with a variable -> dynamic OZArray_initWithItems."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 #import <Foundation/OZString.h>
 #import <Foundation/OZArray.h>
-void test_arr(void) {
-    OZArray *a = @[@"hello", @"world"];
+void test_arr(OZString *s) {
+    OZArray *a = @[s, @"world"];
 }
 @interface Dummy : OZObject
 @end
@@ -1384,13 +2404,13 @@ void test_arr(void) {
         assert found
 
     def test_dictionary_literal(self):
-        """ObjCDictionaryLiteral -> dynamic OZDictionary via initWithKeysValues."""
+        """ObjCDictionaryLiteral with a variable -> dynamic initWithKeysValues."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 #import <Foundation/OZString.h>
 #import <Foundation/OZDictionary.h>
-void test_dict(void) {
-    OZDictionary *d = @{@"key": @"value"};
+void test_dict(OZString *v) {
+    OZDictionary *d = @{@"key": v};
 }
 @interface Dummy : OZObject
 @end
@@ -1406,7 +2426,7 @@ void test_dict(void) {
         assert found
 
     def test_number_literal(self):
-        """ObjCBoxedExpr with IntegerLiteral -> dynamic OZQ31_fixedWithInt32_."""
+        """ObjCBoxedExpr with IntegerLiteral -> immortal static const OZQ31."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 #import <Foundation/OZQ31.h>
@@ -1420,13 +2440,17 @@ void test_num(void) {
 """)
         found = False
         for path, content in out.items():
-            if "OZQ31_fixedWithInt32_(42)" in content:
+            if "(struct OZQ31 *)&_oz_q31_54000000_6" in content:
+                assert ("static const struct OZQ31 _oz_q31_54000000_6 = "
+                        "{{{.class_id = OZ_CLASS_OZQ31, .immortal = 1}, 1}, "
+                        "1409286144, 6};") in content
                 found = True
                 break
         assert found
+        assert not any("OZQ31_fixedWithInt32_(42)" in c for c in out.values())
 
-    def test_number_literal_each_alloc(self):
-        """Each boxed number literal produces its own dynamic allocation."""
+    def test_number_literal_shared_constant(self):
+        """Identical boxed number literals share one immortal constant."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 #import <Foundation/OZQ31.h>
@@ -1440,8 +2464,9 @@ void test_allocs(void) {
 @end
 """)
         for path, content in out.items():
-            if "OZQ31_fixedWithInt32_" in content:
-                assert content.count("OZQ31_fixedWithInt32_(42)") == 2
+            if "_oz_q31_54000000_6" in content:
+                assert content.count("static const struct OZQ31") == 1
+                assert content.count("(struct OZQ31 *)&_oz_q31_54000000_6") == 2
                 break
 
     def test_expr_with_cleanups_passthrough(self):
@@ -1645,10 +2670,8 @@ class TestSynthesizedPropertyEmission:
         m = OZMethod("model", OZType("OZString *"),
                      synthesized_property=prop)
         code = self._emit(cls, m)
-        assert "oz_spinlock_t" not in code
-        assert "OZ_SPINLOCK(&self->base._oz_prop_lock)" in code
-        assert "val = self->_model;" in code
-        assert "= {0};" in code
+        assert "OZ_SPINLOCK" not in code
+        assert "oz_atomic_load_field(&self->_model, &val);" in code
         assert "return val;" in code
 
     def test_nonatomic_strong_setter(self):
@@ -1674,10 +2697,11 @@ class TestSynthesizedPropertyEmission:
                      params=[OZParam("model", OZType("OZString *"))],
                      synthesized_property=prop)
         code = self._emit(cls, m, root_class="OZObject")
-        assert "oz_spinlock_t" not in code
-        assert "OZ_SPINLOCK(&self->base._oz_prop_lock)" in code
-        assert "OZObject_retain(" in code
-        assert "OZObject_release(" in code
+        assert "OZ_SPINLOCK" not in code
+        assert "oz_atomic_ptr_swap(" in code
+        assert "(void **)&self->_model, (void *)model);" in code
+        assert code.index("OZObject_retain(") < code.index("oz_atomic_ptr_swap(")
+        assert "OZObject_release((struct OZObject *)old);" in code
 
     def test_nonatomic_assign_setter(self):
         prop = OZProperty("speed", OZType("int"),
@@ -1702,12 +2726,36 @@ class TestSynthesizedPropertyEmission:
                      params=[OZParam("speed", OZType("int"))],
                      synthesized_property=prop)
         code = self._emit(cls, m)
-        assert "oz_spinlock_t" not in code
-        assert "OZ_SPINLOCK(&self->base._oz_prop_lock)" in code
-        assert "self->_speed = speed;" in code
+        assert "OZ_SPINLOCK" not in code
+        assert "oz_atomic_store_field(&self->_speed, &speed);" in code
         assert "retain" not in code
         assert "release" not in code
 
+    def test_atomic_wide_setter_falls_back_to_lock(self):
+        """Types wider than a pointer keep the root property lock."""
+        prop = OZProperty("odometer", OZType("double"),
+                          ivar_name="_odometer", is_nonatomic=False,
+                          ownership="assign")
+        cls = OZClass("Car")
+        m = OZMethod("setOdometer:", OZType("void"),
+                     params=[OZParam("odometer", OZType("double"))],
+                     synthesized_property=prop)
+        code = self._emit(cls, m)
+        assert "oz_atomic_store_field" not in code
+        assert "OZ_SPINLOCK(&self->base._oz_prop_lock)" in code
+        assert "self->_odometer = odometer;" in code
+
+    def test_atomic_struct_getter_falls_back_to_lock(self):
+        prop = OZProperty("pos", OZType("struct point"),
+                          ivar_name="_pos", is_nonatomic=False,
+                          ownership="assign")
+        cls = OZClass("Car")
+        m = OZMethod("pos", OZType("struct point"),
+                     synthesized_property=prop)
+        code = self._emit(cls, m)
+        assert "oz_atomic_load_field" not in code
+        assert "OZ_SPINLOCK(&self->base._oz_prop_lock)" in code
+
     def test_unsafe_unretained_setter_no_retain(self):
         prop = OZProperty("delegate", OZType("id"),
                           ivar_name="_delegate", is_nonatomic=True,
@@ -1723,18 +2771,18 @@ class TestSynthesizedPropertyEmission:
 
     def test_atomic_getter_val_zero_initialized(self):
         """OZ-085: atomic getter val must be zero-initialized to avoid -Wmaybe-uninitialized."""
-        prop = OZProperty("iterIdx", OZType("uint16_t"),
-                          ivar_name="_iterIdx", is_nonatomic=False,
+        prop = OZProperty("ticks", OZType("int64_t"),
+                          ivar_name="_ticks", is_nonatomic=False,
                           ownership="assign")
         cls = OZClass("Arr")
-        m = OZMethod("iterIdx", OZType("uint16_t"),
+        m = OZMethod("ticks", OZType("int64_t"),
                      synthesized_property=prop)
         code = self._emit(cls, m)
-        assert "uint16_t val = {0};" in code
+        assert "int64_t val = {0};" in code
         assert "return val;" in code
 
-    def test_atomic_strong_setter_old_zero_initialized(self):
-        """OZ-085: atomic strong setter old must be zero-initialized."""
+    def test_atomic_strong_setter_old_initialized_by_swap(self):
+        """OZ-085: atomic strong setter old is initialized by the swap."""
         prop = OZProperty("name", OZType("OZString *"),
                           ivar_name="_name", is_nonatomic=False,
                           ownership="strong")
@@ -1743,11 +2791,11 @@ class TestSynthesizedPropertyEmission:
                      params=[OZParam("name", OZType("OZString *"))],
                      synthesized_property=prop)
         code = self._emit(cls, m, root_class="OZObject")
-        assert "struct OZString * old = {0};" in code
+        assert "struct OZString * old = (struct OZString *)oz_atomic_ptr_swap(" in code
 
     def test_atomic_getter_child_class(self):
         """Grandchild class uses base.base. chain to reach root lock."""
-        prop = OZProperty("temp", OZType("int"),
+        prop = OZProperty("temp", OZType("double"),
                           ivar_name="_temp", is_nonatomic=False,
                           ownership="assign")
         root = OZClass("OZObject")
@@ -1757,7 +2805,7 @@ class TestSynthesizedPropertyEmission:
         module.classes["OZObject"] = root
         module.classes["Vehicle"] = mid
         module.classes["Car"] = child
-        m = OZMethod("temp", OZType("int"), synthesized_property=prop)
+        m = OZMethod("temp", OZType("double"), synthesized_property=prop)
         code = self._emit(child, m, module=module)
         assert "OZ_SPINLOCK(&self->base.base._oz_prop_lock)" in code
         assert "oz_spinlock_t" not in code
@@ -1768,7 +2816,7 @@ class TestSynthesizedPropertyEmission:
 # ===========================================================================
 
 class TestSynchronized:
-    """Tests for @synchronized -> OZSpinLock RAII emission."""
+    """Tests for @synchronized -> striped lock guard emission."""
 
     def test_basic_synchronized(self):
         """@synchronized(self) { self->_count = 1; }"""
@@ -1788,13 +2836,12 @@ class TestSynchronized:
 @end
 """)
         content = out["Foo_ozm.c"]
-        assert "struct OZSpinLock *_sync = OZSpinLock_initWithObject(" in content
-        assert "OZSpinLock_alloc()" in content
-        assert "(struct OZObject *)self" in content
-        assert "OZObject_release((struct OZObject *)_sync);" in content
+        assert "struct oz_sync_stripe *_sync = oz_sync_enter(self);" in content
+        assert "oz_sync_exit(_sync);" in content
+        assert "OZObject_release((struct OZObject *)_sync)" not in content
 
-    def test_synchronized_oz_spinlock_slab(self):
-        """OZSpinLock slab generated when @synchronized is used."""
+    def test_synchronized_lock_table(self):
+        """Lock stripe table generated when @synchronized is used."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 @interface Foo : OZObject
@@ -1807,7 +2854,11 @@ class TestSynchronized:
 @end
 """)
         dispatch_h = out["Foundation/oz_dispatch.h"]
-        assert "OZ_CLASS_OZSpinLock" in dispatch_h
+        assert '#include "platform/oz_lock.h"' in dispatch_h
+        assert "OZ_CLASS_OZSpinLock" not in dispatch_h
+        dispatch_c = out["Foundation/oz_dispatch.c"]
+        assert ("struct oz_sync_stripe oz_sync_stripes[OZ_SYNC_LOCK_STRIPES];"
+                in dispatch_c)
 
     def test_synchronized_early_return(self):
         """Early return inside @synchronized releases the lock."""
@@ -1826,7 +2877,7 @@ class TestSynchronized:
 """)
         content = out["Foo_ozm.c"]
         ret_pos = content.index("return;")
-        release_pos = content.index("OZObject_release((struct OZObject *)_sync)")
+        release_pos = content.index("oz_sync_exit(_sync);")
         assert release_pos < ret_pos
 
     def test_synchronized_nested_mangled_names(self):
@@ -1845,11 +2896,11 @@ class TestSynchronized:
 @end
 """)
         content = out["Foo_ozm.c"]
-        assert "struct OZSpinLock *_sync = " in content
-        assert "struct OZSpinLock *_sync2 = " in content
+        assert "struct oz_sync_stripe *_sync = " in content
+        assert "struct oz_sync_stripe *_sync2 = " in content
 
-    def test_no_oz_spinlock_without_synchronized(self):
-        """OZSpinLock not injected when no @synchronized used."""
+    def test_no_lock_table_without_synchronized(self):
+        """Lock table not emitted when no @synchronized used."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 @interface Foo : OZObject
@@ -1860,7 +2911,8 @@ class TestSynchronized:
 @end
 """)
         dispatch_h = out["Foundation/oz_dispatch.h"]
-        assert "OZSpinLock" not in dispatch_h
+        assert "oz_lock.h" not in dispatch_h
+        assert "oz_sync_stripes" not in out["Foundation/oz_dispatch.c"]
 
     def test_synchronized_with_ivar_obj(self):
         """@synchronized(_mutex) uses ivar expression."""
@@ -1881,7 +2933,7 @@ class TestSynchronized:
 @end
 """)
         content = out["Foo_ozm.c"]
-        assert "(struct OZObject *)self->_mutex" in content
+        assert "oz_sync_enter(self->_mutex)" in content
 
     def test_synchronized_with_object_local_inside(self):
         """Object local inside @synchronized released alongside _sync."""
@@ -1900,7 +2952,7 @@ class TestSynchronized:
 """)
         content = out["Foo_ozm.c"]
         assert "OZObject_release((struct OZObject *)tmp)" in content
-        assert "OZObject_release((struct OZObject *)_sync)" in content
+        assert "oz_sync_exit(_sync);" in content
 
     def test_synchronized_in_loop_break_releases(self):
         """Break inside @synchronized inside loop releases _sync."""
@@ -1922,7 +2974,7 @@ class TestSynchronized:
         content = out["Foo_ozm.c"]
         break_idx = content.index("break;")
         before_break = content[:break_idx]
-        assert "release((struct OZObject *)_sync)" in before_break
+        assert "oz_sync_exit(_sync);" in before_break
 
     def test_synchronized_return_with_value(self):
         """Return expr inside @synchronized releases _sync but not returned var."""
@@ -1941,7 +2993,7 @@ class TestSynchronized:
 """)
         content = out["Foo_ozm.c"]
         ret_pos = content.index("return 42;")
-        release_pos = content.index("release((struct OZObject *)_sync)")
+        release_pos = content.index("oz_sync_exit(_sync);")
         assert release_pos < ret_pos
 
     def test_sequential_synchronized_counter(self):
@@ -1959,11 +3011,11 @@ class TestSynchronized:
 @end
 """)
         content = out["Foo_ozm.c"]
-        assert "struct OZSpinLock *_sync = " in content
-        assert "struct OZSpinLock *_sync2 = " in content
+        assert "struct oz_sync_stripe *_sync = " in content
+        assert "struct oz_sync_stripe *_sync2 = " in content
 
-    def test_dispatch_free_includes_oz_spinlock(self):
-        """dispatch_free switch includes OZSpinLock case."""
+    def test_synchronized_needs_no_slab(self):
+        """@synchronized allocates no lock object."""
         _, out = clang_emit("""\
 #import <Foundation/OZObject.h>
 @interface Foo : OZObject
@@ -1976,7 +3028,7 @@ class TestSynchronized:
 @end
 """)
         dispatch_c = out["Foundation/oz_dispatch.c"]
-        assert "case OZ_CLASS_OZSpinLock: OZSpinLock_free(" in dispatch_c
+        assert "OZSpinLock" not in dispatch_c
 
     def test_synchronized_compiles_on_host(self):
         """Generated @synchronized code compiles with GCC on host."""
@@ -2042,6 +3094,31 @@ class TestSynchronized:
                     f"Compile failed for {os.path.basename(f)}:\n{result.stderr}"
                 )
 
+    def test_nested_return_exits_both_guards(self):
+        """return inside nested @synchronized exits inner then outer guard."""
+        obj = {"kind": "DeclRefExpr", "referencedDecl": {"name": "obj"},
+               "type": {"qualType": "Sensor *"}}
+        inner = {"kind": "ObjCAtSynchronizedStmt", "inner": [
+            obj, {"kind": "CompoundStmt", "inner": [{"kind": "ReturnStmt"}]}]}
+        outer = {"kind": "ObjCAtSynchronizedStmt", "inner": [
+            obj, {"kind": "CompoundStmt", "inner": [inner]}]}
+        m = _sensor_module()
+        m.functions.append(OZFunction(
+            name="locked", return_type=OZType("void"),
+            body_ast={"kind": "CompoundStmt", "inner": [outer]}))
+        resolve(m)
+        with tempfile.TemporaryDirectory() as tmpdir:
+            emit(m, tmpdir)
+            src = "".join(open(os.path.join(tmpdir, f)).read()
+                          for f in os.listdir(tmpdir) if f.endswith(".c"))
+        body = src[src.index("void locked(void)"):]
+        assert "struct oz_sync_stripe *_sync = oz_sync_enter(obj);" in body
+        assert "struct oz_sync_stripe *_sync2 = oz_sync_enter(obj);" in body
+        ret = body.index("return;")
+        assert (body.index("oz_sync_exit(_sync2);")
+                < body.index("oz_sync_exit(_sync);") < ret)
+        assert "_release" not in body
+
 
 # ===========================================================================
 # Patched emission tests — kept synthetic (tests tree-sitter functions directly)
@@ -3160,10 +4237,10 @@ void test_lit(void) {
 @end
 """)
         for path, content in out.items():
-            if "OZQ31_fixedWithInt32_(99)" in content:
+            if "(struct OZQ31 *)&_oz_q31_63000000_7" in content:
                 break
         else:
-            assert False, "OZQ31_fixedWithInt32_(99) not found"
+            assert False, "_oz_q31_63000000_7 not found"
         assert not mod.errors
 
 
@@ -3253,7 +4330,8 @@ class TestEmitEdgeCases:
 @end
 @implementation Foo
 - (void)test_lit {
-    OZArray *arr = @[@"a", @"b"];
+    OZString *a = @"a";
+    OZArray *arr = @[a, @"b"];
 }
 @end
 """)
@@ -3271,7 +4349,8 @@ class TestEmitEdgeCases:
 @end
 @implementation Foo
 - (void)test_lit {
-    OZDictionary *dict = @{@"key": @"val"};
+    OZString *val = @"val";
+    OZDictionary *dict = @{@"key": val};
 }
 @end
 """)
@@ -3292,8 +4371,8 @@ class TestEmitEdgeCases:
 @end
 """)
         src = out["Foo_ozm.c"]
-        assert "OZ_PROTOCOL_SEND_iter" in src
-        assert "OZ_PROTOCOL_SEND_next" in src
+        assert "struct NSFastEnumerationState" in src
+        assert "OZ_PROTOCOL_SEND_countByEnumeratingWithState_objects_count_" in src
         assert "item" in src
 
     def test_forin_typed_var_struct_prefix(self):
@@ -0,0 +1,119 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import json
+import struct
+
+import pytest
+
+from oz_transpile.logdecode import (
+    LogDecodeError,
+    LogDict,
+    decode,
+    main,
+    parse_hex,
+    q31_to_str,
+)
+
+
+def _dict():
+    return LogDict({
+        "version": 1,
+        "classes": [
+            {"id": 0, "name": "OZObject", "super": None},
+            {"id": 1, "name": "OZString", "super": "OZObject"},
+            {"id": 2, "name": "OZMutableString", "super": "OZString"},
+            {"id": 3, "name": "OZQ31", "super": "OZObject"},
+            {"id": 4, "name": "Led", "super": "OZObject"},
+        ],
+        "messages": [
+            {"id": 0, "fmt": "v=%d %s %08lx %c",
+             "parts": [["lit", "v="], ["arg", "%d", "i32"], ["lit", " "],
+                       ["arg", "%s", "str"], ["lit", " "],
+                       ["arg", "%08lx", "u64"], ["lit", " "],
+                       ["arg", "%c", "i32"]]},
+            {"id": 1, "fmt": "%@|%.2@|%@|%@",
+             "parts": [["obj", -1], ["lit", "|"], ["obj", 2], ["lit", "|"],
+                       ["obj", -1], ["lit", "|"], ["obj", -1]]},
+            {"id": 2, "fmt": "boot", "parts": [["lit", "boot"]]},
+        ],
+    })
+
+
+def _record(msg_id, payload):
+    pad = b"\0" * (-len(payload) % 4)
+    return struct.pack("<HH", msg_id, len(payload)) + payload + pad
+
+
+class TestQ31ToStr:
+    def test_matches_runtime(self):
+        # Values from tests/behavior/cases/foundation/q31_stdio_free_test.c
+        assert q31_to_str(0, 0) == "0"
+        assert q31_to_str(10 << 27, 4) == "10"
+        assert q31_to_str(-1073741824, 0) == "-0.5"
+        assert q31_to_str(715827882, 0) == "0.33333333302289"
+        assert q31_to_str(1431655765, 0, 6) == "0.666667"
+        assert q31_to_str(2147483647, 0, 6) == "1"
+        assert q31_to_str(3, 30) == "1.5"
+
+
+class TestDecode:
+    def test_scalar_args(self):
+        payload = (struct.pack("<i", -7) + b"\x02hi"
+                   + struct.pack("<Q", 0xBEEF) + struct.pack("<i", 65))
+        assert decode(_dict(), _record(0, payload)) == [
+            "v=-7 hi 0000beef A"]
+
+    def test_null_string(self):
+        payload = (struct.pack("<i", 1) + b"\xff"
+                   + struct.pack("<Q", 0) + struct.pack("<i", 66))
+        assert decode(_dict(), _record(0, payload)) == [
+            "v=1 (null) 00000000 B"]
+
+    def test_objects(self):
+        payload = (struct.pack("<HB", 2, 3) + b"abc"
+                   + struct.pack("<HB", 3, 5) + struct.pack("<iB", 715827882, 0)
+                   + struct.pack("<HB", 4, 0)
+                   + struct.pack("<HB", 0xFFFF, 0))
+        assert decode(_dict(), _record(1, payload)) == [
+            "abc|0.33|<Led>|(nil)"]
+
+    def test_record_sequence(self):
+        # Odd payload lengths are padded to 4 bytes between records
+        args = (struct.pack("<i", 3) + b"\x00" + struct.pack("<Q", 1)
+                + struct.pack("<i", 67))
+        data = _record(2, b"") + _record(0, args) + _record(2, b"")
+        assert decode(_dict(), data) == ["boot", "v=3  00000001 C", "boot"]
+
+    def test_unknown_id(self):
+        with pytest.raises(LogDecodeError):
+            decode(_dict(), _record(9, b""))
+
+    def test_truncated_payload(self):
+        with pytest.raises(LogDecodeError):
+            decode(_dict(), _record(0, struct.pack("<i", 3)))
+
+    def test_rejects_unknown_version(self):
+        with pytest.raises(LogDecodeError):
+            LogDict({"version": 2, "classes": [], "messages": []})
+
+
+class TestParseHex:
+    def test_shell_output(self):
+        data, dropped = parse_hex("uart:~$ oz_log\n02000000\n"
+                                  "02000000\n# dropped 3\nuart:~$ \n")
+        assert data == _record(2, b"") * 2
+        assert dropped == 3
+
+
+class TestMain:
+    def test_one_line_per_record(self, tmp_path, capsys):
+        dict_path = tmp_path / "oz_log_dict.json"
+        dict_path.write_text(json.dumps({
+            "version": 1, "classes": [],
+            "messages": [{"id": 2, "fmt": "boot",
+                          "parts": [["lit", "boot"]]}],
+        }))
+        log_path = tmp_path / "oz_log.bin"
+        log_path.write_bytes(_record(2, b"") * 2)
+        assert main([str(dict_path), str(log_path)]) == 0
+        assert capsys.readouterr().out == "boot\nboot\n"
@@ -3,6 +3,8 @@
 from oz_transpile.__main__ import (
     _associate_module_items_with_class,
     _source_stem,
+    parse_dispatch_profile,
+    parse_pool_profile,
     parse_pool_sizes,
 )
 from oz_transpile.model import (OZClass, OZFunction, OZMethod, OZModule,
@@ -33,6 +35,56 @@ class TestParsePoolSizes:
         assert result == {"OZLed": 4, "OZBar": 1}
 
 
+class TestParsePoolProfile:
+    def test_empty(self):
+        assert parse_pool_profile("") == {}
+
+    def test_peak_plus_margin_rounds_up(self):
+        text = "OZLed 4 16 0\nOZRgbLed 3 8 0\n"
+        assert parse_pool_profile(text, margin=25) == {
+            "OZLed": 5, "OZRgbLed": 4}
+
+    def test_zero_margin_is_exact_peak(self):
+        assert parse_pool_profile("OZLed 4 16 0\n", margin=0) == {"OZLed": 4}
+
+    def test_unused_class_keeps_one_block(self):
+        assert parse_pool_profile("OZLed 0 16 0\n") == {"OZLed": 1}
+
+    def test_failures_add_to_demand(self):
+        assert parse_pool_profile("OZLed 2 2 3\n", margin=0) == {"OZLed": 5}
+
+    def test_appended_runs_take_max(self):
+        text = "OZLed 2 16 0\nOZLed 6 16 0\nOZLed 3 16 0\n"
+        assert parse_pool_profile(text, margin=0) == {"OZLed": 6}
+
+    def test_comments_and_malformed_lines_ignored(self):
+        text = ("# oz-pool-profile: <class> <peak> <blocks> <failures>\n"
+                "OZLed 2 16\nOZLed x 16 0\nOZBar 2 4 0\n")
+        assert parse_pool_profile(text, margin=0) == {"OZBar": 2}
+
+
+class TestParseDispatchProfile:
+    def test_empty(self):
+        assert parse_dispatch_profile("") == {}
+
+    def test_dominant_class(self):
+        text = "read Sensor 3\nread TempSensor 10\nreset Led 1\n"
+        assert parse_dispatch_profile(text) == {
+            "read": "TempSensor", "reset": "Led"}
+
+    def test_appended_runs_are_summed(self):
+        text = "read Sensor 6\nread TempSensor 5\nread TempSensor 5\n"
+        assert parse_dispatch_profile(text) == {"read": "TempSensor"}
+
+    def test_tie_is_deterministic(self):
+        text = "read TempSensor 4\nread Sensor 4\n"
+        assert parse_dispatch_profile(text) == {"read": "Sensor"}
+
+    def test_comments_and_malformed_lines_ignored(self):
+        text = "# header\n\nread Sensor\nread Sensor x\nreset Led 2\n"
+        assert parse_dispatch_profile(text) == {"reset": "Led"}
+
+
 class TestSourceStem:
     def test_basic_path(self):
         assert _source_stem("/a/b/Producer.m") == "Producer"
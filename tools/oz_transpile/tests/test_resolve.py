@@ -55,6 +55,41 @@ class TestClassIds:
         assert mod.classes["OZObject"].class_id == 0
 
 
+class TestPreorderClassIds:
+    """Class ids follow DFS preorder so each subtree is contiguous."""
+
+    def _module(self):
+        m = OZModule()
+        m.classes["OZObject"] = OZClass("OZObject")
+        m.classes["A"] = OZClass("A", superclass="OZObject")
+        m.classes["B"] = OZClass("B", superclass="OZObject")
+        m.classes["C"] = OZClass("C", superclass="A")
+        m.classes["D"] = OZClass("D", superclass="C")
+        resolve(m)
+        return m
+
+    def test_subclass_follows_parent_before_sibling(self):
+        m = self._module()
+        ids = {n: c.class_id for n, c in m.classes.items()}
+        assert ids == {"OZObject": 0, "A": 1, "C": 2, "D": 3, "B": 4}
+
+    def test_subtrees_contiguous(self):
+        m = self._module()
+        for name, cls in m.classes.items():
+            sub = sorted(c.class_id for c in m.classes.values()
+                         if c.name == name or _chain_has(m, c.name, name))
+            assert sub == list(range(cls.class_id, cls.class_id + len(sub)))
+
+
+def _chain_has(m, name, ancestor):
+    sup = m.classes[name].superclass
+    while sup:
+        if sup == ancestor:
+            return True
+        sup = m.classes[sup].superclass if sup in m.classes else None
+    return False
+
+
 class TestBaseDepth:
     def test_root_depth_zero(self):
         mod = clang_collect_resolve("""\